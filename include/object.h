@@ -444,6 +444,7 @@ struct _typeobject {
     void* _gcvisit_func;
     int _attrs_offset;
     bool _flags[2];
+    int _num_inline_attrs;
 };
 
 // Pyston change: hacks to allow C++ features
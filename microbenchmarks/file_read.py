@@ -0,0 +1,16 @@
+# File throughput: reading a few MB line by line, with readlines(), and all at once.
+
+fn = "/tmp/pyston_file_read_bench.txt"
+f = open(fn, "w")
+line = "2014-06-01 12:00:00,123 INFO [worker-7] GET /api/v1/items?id=42 200 0.0123s\n"
+for i in xrange(50000):
+    f.write(line)
+f.close()
+
+total = 0
+for i in xrange(20):
+    for l in open(fn):
+        total += len(l)
+    total += len(open(fn).readlines())
+    total += len(open(fn).read())
+print total
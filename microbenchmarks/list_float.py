@@ -0,0 +1,19 @@
+# Numeric code over lists of floats and ints: [0.0] * n, indexed loads and stores, and append loops.
+def f(n):
+    a = [0.0] * n
+    b = []
+    for i in xrange(n):
+        a[i] = i * 0.5
+        b.append(i)
+
+    t = 0.0
+    for k in xrange(20):
+        for i in xrange(1, n):
+            a[i] = a[i] + a[i - 1] * 0.001
+        for x in a:
+            t = t + x
+    s = 0
+    for x in b:
+        s = s + x
+    return t, s
+print f(200000)
@@ -13,3 +13,27 @@ for i in xrange(N):
     l.append(N - i)
 sort(l)
 print l
+
+# list.sort on random, presorted and partially sorted input, with and without key= and reverse=:
+def pseudorandom(n, seed=1):
+    r = []
+    for i in xrange(n):
+        seed = (seed * 75 + 74) % 65537
+        r.append(seed)
+    return r
+
+N = 200000
+ints = pseudorandom(N)
+floats = [x * 0.5 for x in ints]
+strs = [str(x) for x in ints]
+inputs = [ints, floats, strs, range(N), range(N, 0, -1), range(N / 2) + pseudorandom(N / 2)]
+
+for i in xrange(5):
+    for data in inputs:
+        l = list(data)
+        l.sort()
+        l = list(data)
+        l.sort(reverse=True)
+    l = sorted(ints, key=lambda x: -x)
+    l = sorted(strs, key=len)
+print l[:3], l[-3:]
@@ -0,0 +1,28 @@
+# Builds up log lines and a CSV file one piece at a time with +=,
+# which is quadratic unless strings can be appended to in place.
+
+def make_log(n):
+    log = ""
+    for i in xrange(n):
+        line = "[" + str(i) + "] "
+        line += "INFO "
+        line += "request handled in " + str(i % 97) + "ms"
+        log += line + "\n"
+    return log
+
+def make_csv(rows, cols):
+    out = ""
+    for r in xrange(rows):
+        line = ""
+        for c in xrange(cols):
+            if c:
+                line += ","
+            line += str(r * c)
+        out += line + "\n"
+    return out
+
+total = 0
+for i in xrange(10):
+    total += len(make_log(20000))
+    total += len(make_csv(2000, 20))
+print total
@@ -0,0 +1,14 @@
+# Case conversion and joining, as used when normalizing fields.
+
+words = ["Alpha", "BETA", "gamma", "Delta", "EPSILON", "zeta", "Eta", "THETA"]
+sentence = "The Quick Brown Fox Jumps Over The Lazy Dog, Again And Again And Again."
+
+def f(n):
+    t = 0
+    for i in xrange(n):
+        t += len(sentence.lower())
+        t += len(sentence.upper())
+        t += len(" ".join(words))
+    return t
+
+print f(500000)
@@ -0,0 +1,17 @@
+# Substring search: membership tests and counting, on a moderately long line.
+
+line = "2014-06-01 12:00:00,123 INFO [worker-7] GET /api/v1/items?id=42 200 0.0123s user=alice agent=curl/7.35.0"
+
+def f(n):
+    t = 0
+    for i in xrange(n):
+        if "ERROR" in line:
+            t += 1
+        if "agent=" in line:
+            t += 2
+        t += line.count("/")
+        t += line.count("=")
+        t += line.count("200")
+    return t
+
+print f(500000)
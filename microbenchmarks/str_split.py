@@ -0,0 +1,14 @@
+# Log-parsing style string work: splitting lines on whitespace and on a separator, and stripping.
+
+line = "  2014-06-01 12:00:00,123 INFO [worker-7] GET /api/v1/items?id=42 200 0.0123s  "
+csv = "alpha,beta,gamma,delta,epsilon,zeta,eta,theta,iota,kappa"
+
+def f(n):
+    t = 0
+    for i in xrange(n):
+        t += len(line.split())
+        t += len(csv.split(","))
+        t += len(line.strip())
+    return t
+
+print f(500000)
@@ -120,6 +120,25 @@ private:
         return old_type;
     }
 
+    // Speculate based on the histogram of classes that were seen at this node.
+    // We can only give the node a single unboxed type, and a failed guard sends
+    // the rest of the function down the slower deopt path, so only speculate when
+    // a single class accounts for practically all of the observations.
+    // For truly polymorphic sites we leave the value boxed, rather than paying for
+    // a deopt every time one of the less-common classes shows up.
+    CompilerType* processSpeculation(const std::vector<BoxedClass*>& seen_classes, AST_expr* node,
+                                     CompilerType* old_type) {
+        if (seen_classes.size() > 1) {
+            if (VERBOSITY() >= 2) {
+                printf("in propagator, not speculating on a site that has seen %ld classes:\n", seen_classes.size());
+                print_ast(node);
+                printf("\n");
+            }
+            return old_type;
+        }
+        return processSpeculation(seen_classes.size() ? seen_classes[0] : NULL, node, old_type);
+    }
+
     CompilerType* getType(AST_expr* node) {
         type_speculations.erase(node);
 
@@ -172,8 +191,8 @@ private:
         //}
 
         if (speculation != TypeAnalysis::NONE) {
-            BoxedClass* speculated_class = predictClassFor(node);
-            rtn = processSpeculation(speculated_class, node, rtn);
+            std::vector<BoxedClass*> seen_classes = predictClassesFor(node);
+            rtn = processSpeculation(seen_classes, node, rtn);
         }
 
         if (VERBOSITY() >= 2 && rtn == UNDEF) {
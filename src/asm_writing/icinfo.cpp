@@ -14,6 +14,7 @@
 
 #include "asm_writing/icinfo.h"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
 
@@ -21,9 +22,11 @@
 
 #include "asm_writing/assembler.h"
 #include "asm_writing/mc_writer.h"
+#include "codegen/codegen.h"
 #include "codegen/patchpoints.h"
 #include "core/common.h"
 #include "core/options.h"
+#include "core/stats.h"
 #include "core/types.h"
 
 namespace pyston {
@@ -53,7 +56,8 @@ void ICSlotInfo::clear() {
     ic->clear(this);
 }
 
-ICSlotRewrite::ICSlotRewrite(ICInfo* ic, const char* debug_name) : ic(ic), debug_name(debug_name) {
+ICSlotRewrite::ICSlotRewrite(ICInfo* ic, const char* debug_name)
+    : ic(ic), debug_name(debug_name), commit_attempted(false) {
     buf = (uint8_t*)malloc(ic->getSlotSize());
     assembler = new Assembler(buf, ic->getSlotSize());
     assembler->nop();
@@ -63,11 +67,16 @@ ICSlotRewrite::ICSlotRewrite(ICInfo* ic, const char* debug_name) : ic(ic), debug
 }
 
 ICSlotRewrite::~ICSlotRewrite() {
+    if (!commit_attempted)
+        ic->counters.aborts_abandoned++;
+
     delete assembler;
     free(buf);
 }
 
 void ICSlotRewrite::commit(uint64_t decision_path, CommitHook* hook) {
+    commit_attempted = true;
+
     bool still_valid = true;
     for (int i = 0; i < dependencies.size(); i++) {
         int orig_version = dependencies[i].second;
@@ -80,12 +89,16 @@ void ICSlotRewrite::commit(uint64_t decision_path, CommitHook* hook) {
     if (!still_valid) {
         if (VERBOSITY())
             printf("not committing %s icentry since a dependency got updated before commit\n", debug_name);
+        ic->counters.aborts_invalidated++;
         return;
     }
 
     ICSlotInfo* ic_entry = ic->pickEntryForRewrite(decision_path, debug_name);
-    if (ic_entry == NULL)
+    if (ic_entry == NULL) {
+        ic->counters.aborts_incompatible++;
         return;
+    }
+    ic->counters.rewrites_committed++;
 
     for (int i = 0; i < dependencies.size(); i++) {
         ICInvalidator* invalidator = dependencies[i].first;
@@ -140,9 +153,31 @@ assembler::GenericRegister ICSlotRewrite::returnRegister() {
 
 
 ICSlotRewrite* ICInfo::startRewrite(const char* debug_name) {
+    this->debug_name = debug_name;
     return new ICSlotRewrite(this, debug_name);
 }
 
+int ICInfo::numPatchedSlots() {
+    int rtn = 0;
+    for (const SlotInfo& sinfo : slots) {
+        if (sinfo.is_patched)
+            rtn++;
+    }
+    return rtn;
+}
+
+// After this many evictions, we stop trying to rewrite the IC.
+static const int MEGAMORPHIC_THRESHOLD = 100;
+
+bool ICInfo::isMegamorphic() {
+    return num_evictions >= MEGAMORPHIC_THRESHOLD;
+}
+
+static StatCounter ic_to_monomorphic("ic_transitions_to_monomorphic");
+static StatCounter ic_to_polymorphic("ic_transitions_to_polymorphic");
+static StatCounter ic_to_megamorphic("ic_transitions_to_megamorphic");
+static StatCounter ic_evictions("ic_evictions");
+
 ICSlotInfo* ICInfo::pickEntryForRewrite(uint64_t decision_path, const char* debug_name) {
     for (int i = 0; i < getNumSlots(); i++) {
         SlotInfo& sinfo = slots[i];
@@ -151,6 +186,11 @@ ICSlotInfo* ICInfo::pickEntryForRewrite(uint64_t decision_path, const char* debu
                 printf("committing %s icentry to unused slot %d at %p\n", debug_name, i, start_addr);
             }
 
+            if (i == 0)
+                ic_to_monomorphic.log();
+            else if (i == 1)
+                ic_to_polymorphic.log();
+
             sinfo.is_patched = true;
             sinfo.decision_path = decision_path;
             return &sinfo.entry;
@@ -171,6 +211,18 @@ ICSlotInfo* ICInfo::pickEntryForRewrite(uint64_t decision_path, const char* debu
         }
         next_slot_to_try++;
 
+        // Slots that got cleared by invalidation are free again and get picked up by the loop above,
+        // so this only counts overwriting an entry that was still live:
+        if (sinfo.is_patched) {
+            num_evictions++;
+            ic_evictions.log();
+            if (num_evictions == MEGAMORPHIC_THRESHOLD) {
+                if (VERBOSITY())
+                    printf("%s ic at %p is now megamorphic; won't rewrite it any more\n", debug_name, start_addr);
+                ic_to_megamorphic.log();
+            }
+        }
+
         sinfo.is_patched = true;
         sinfo.decision_path = decision_path;
         return &sinfo.entry;
@@ -185,9 +237,10 @@ ICSlotInfo* ICInfo::pickEntryForRewrite(uint64_t decision_path, const char* debu
 ICInfo::ICInfo(void* start_addr, void* continue_addr, StackInfo stack_info, int num_slots, int slot_size,
                llvm::CallingConv::ID calling_conv, const std::unordered_set<int>& live_outs,
                assembler::GenericRegister return_register, TypeRecorder* type_recorder)
-    : next_slot_to_try(0), stack_info(stack_info), num_slots(num_slots), slot_size(slot_size),
-      calling_conv(calling_conv), live_outs(live_outs.begin(), live_outs.end()), return_register(return_register),
-      type_recorder(type_recorder), start_addr(start_addr), continue_addr(continue_addr) {
+    : next_slot_to_try(0), num_evictions(0), debug_name(NULL), stack_info(stack_info), num_slots(num_slots),
+      slot_size(slot_size), calling_conv(calling_conv), live_outs(live_outs.begin(), live_outs.end()),
+      return_register(return_register), type_recorder(type_recorder), start_addr(start_addr),
+      continue_addr(continue_addr) {
     for (int i = 0; i < num_slots; i++) {
         slots.push_back(SlotInfo(this, i));
     }
@@ -263,6 +316,49 @@ ICInfo* getICInfo(void* rtn_addr) {
     return it->second;
 }
 
+static const char* icStateName(ICInfo* ic) {
+    if (ic->isMegamorphic())
+        return "megamorphic";
+    int npatched = ic->numPatchedSlots();
+    if (npatched == 0)
+        return "unpatched";
+    if (npatched == 1)
+        return "monomorphic";
+    return "polymorphic";
+}
+
+void dumpICStats(int max_entries) {
+    std::vector<ICInfo*> ics;
+    for (const auto& p : ics_by_return_addr) {
+        if (p.second->counters.rewrite_attempts)
+            ics.push_back(p.second);
+    }
+
+    // Sort the sites that enter their slowpath the most to the front:
+    std::sort(ics.begin(), ics.end(), [](ICInfo* lhs, ICInfo* rhs) {
+        return lhs->counters.rewrite_attempts > rhs->counters.rewrite_attempts;
+    });
+
+    printf("IC stats (%ld ICs hit their slowpath, showing up to %d):\n", ics.size(), max_entries);
+    for (int i = 0; i < ics.size() && i < max_entries; i++) {
+        ICInfo* ic = ics[i];
+        const ICCounters& c = ic->counters;
+
+        const LineInfo* line_info = getLineInfoFor((uint64_t)ic->start_addr);
+        if (line_info)
+            printf("%s:%d (%s)", line_info->file.c_str(), line_info->line, line_info->func.c_str());
+        else
+            printf("%p", ic->start_addr);
+
+        printf(" %s: %s, %d/%d slots patched\n", ic->getDebugName() ? ic->getDebugName() : "<unknown>",
+               icStateName(ic), ic->numPatchedSlots(), ic->getNumSlots());
+        printf("    %ld slowpath rewrite attempts, %ld rewrites, %d evictions\n", c.rewrite_attempts,
+               c.rewrites_committed, ic->numEvictions());
+        printf("    aborts: %ld abandoned, %ld invalidated, %ld incompatible, %ld megamorphic\n", c.aborts_abandoned,
+               c.aborts_invalidated, c.aborts_incompatible, c.aborts_megamorphic);
+    }
+}
+
 void ICInfo::clear(ICSlotInfo* icentry) {
     assert(icentry);
 
@@ -280,5 +376,16 @@ void ICInfo::clear(ICSlotInfo* icentry) {
 
     // writer->endWithSlowpath();
     llvm::sys::Memory::InvalidateInstructionCache(start, getSlotSize());
+
+    // The slot just falls through to the slowpath now, so it's free to be reused without evicting anything:
+    SlotInfo& sinfo = slots[icentry->idx];
+    assert(&sinfo.entry == icentry);
+    sinfo.is_patched = false;
+    sinfo.decision_path = 0;
+
+    // Whatever made the IC megamorphic was probably tied to the state that just got invalidated (ex
+    // classes getting set up during warmup), so give it another chance instead of leaving it
+    // unrewritable for the rest of the process:
+    num_evictions = 0;
 }
 }
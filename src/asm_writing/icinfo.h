@@ -15,6 +15,7 @@
 #ifndef PYSTON_ASMWRITING_ICINFO_H
 #define PYSTON_ASMWRITING_ICINFO_H
 
+#include <cstdint>
 #include <unordered_set>
 #include <vector>
 
@@ -54,6 +55,10 @@ private:
 
     uint8_t* buf;
 
+    // Whether commit() got called; rewrites that get destroyed without being committed
+    // were abandoned by the runtime code that started them.
+    bool commit_attempted;
+
     std::vector<std::pair<ICInvalidator*, int64_t> > dependencies;
 
     ICSlotRewrite(ICInfo* ic, const char* debug_name);
@@ -77,6 +82,18 @@ public:
     friend class ICInfo;
 };
 
+// Per-IC profiling counters, reported by dumpICStats().
+struct ICCounters {
+    int64_t rewrite_attempts = 0;
+    int64_t rewrites_committed = 0;
+
+    // Reasons that a rewrite that got started didn't end up getting committed:
+    int64_t aborts_abandoned = 0;    // the runtime code bailed out of rewriting
+    int64_t aborts_invalidated = 0;  // a dependency got invalidated before the commit
+    int64_t aborts_incompatible = 0; // no slot was compatible with the decision path
+    int64_t aborts_megamorphic = 0;  // we didn't try since the IC is megamorphic
+};
+
 class ICInfo {
 private:
     struct SlotInfo {
@@ -93,6 +110,15 @@ private:
     // that it's replacing.
     int next_slot_to_try;
 
+    // Number of times we had to overwrite an in-use slot.  Once this gets high enough,
+    // the IC is considered megamorphic and we stop rewriting it: at that point each rewrite
+    // just evicts some other entry that will be needed again soon, and we pay for
+    // the assembly + icache flush on every slowpath call.  Clearing a slot resets it.
+    int num_evictions;
+
+    // The debug name passed to the most recent startRewrite() call:
+    const char* debug_name;
+
     const StackInfo stack_info;
     const int num_slots;
     const int slot_size;
@@ -115,11 +141,18 @@ public:
     int getSlotSize() { return slot_size; }
     int getNumSlots() { return num_slots; }
     llvm::CallingConv::ID getCallingConvention() { return calling_conv; }
+    bool isMegamorphic();
     const std::vector<int>& getLiveOuts() { return live_outs; }
 
+    ICCounters counters;
+
     ICSlotRewrite* startRewrite(const char* debug_name);
     void clear(ICSlotInfo* entry);
 
+    int numPatchedSlots();
+    int numEvictions() { return num_evictions; }
+    const char* getDebugName() { return debug_name; }
+
     friend class ICSlotRewrite;
 };
 
@@ -128,6 +161,9 @@ void registerCompiledPatchpoint(uint8_t* start_addr, PatchpointSetupInfo*, Stack
                                 std::unordered_set<int> live_outs);
 
 ICInfo* getICInfo(void* rtn_addr);
+
+// Prints the ICs that have hit their slowpaths the most, along with their profiling counters.
+void dumpICStats(int max_entries);
 }
 
 #endif
@@ -985,6 +985,17 @@ Rewriter* Rewriter::createRewriter(void* rtn_addr, int num_args, const char* deb
         return NULL;
     }
 
+    ic->counters.rewrite_attempts++;
+
+    // Don't bother rewriting megamorphic ICs; we'd just end up evicting a different entry.
+    // The slowpath will handle it, and the existing entries will continue to work.
+    if (ic->isMegamorphic()) {
+        static StatCounter rewriter_megamorphic("rewriter_megamorphic");
+        rewriter_megamorphic.log();
+        ic->counters.aborts_megamorphic++;
+        return NULL;
+    }
+
     return new Rewriter(ic->startRewrite(debug_name), num_args, ic->getLiveOuts());
 }
 
@@ -196,7 +196,7 @@ public:
 
     void setattr(IREmitter& emitter, const OpInfo& info, ConcreteCompilerVariable* var, const std::string* attr,
                  CompilerVariable* v) {
-        llvm::Constant* ptr = getStringConstantPtr(*attr + '\0');
+        llvm::Constant* ptr = embedConstantPtr(internAttrName(*attr), g.llvm_str_type_ptr);
         ConcreteCompilerVariable* converted = v->makeConverted(emitter, UNKNOWN);
         // g.funcs.setattr->dump();
         // var->getValue()->dump(); llvm::errs() << '\n';
@@ -220,7 +220,7 @@ public:
     }
 
     void delattr(IREmitter& emitter, const OpInfo& info, ConcreteCompilerVariable* var, const std::string* attr) {
-        llvm::Constant* ptr = getStringConstantPtr(*attr + '\0');
+        llvm::Constant* ptr = embedConstantPtr(internAttrName(*attr), g.llvm_str_type_ptr);
 
         // TODO
         // bool do_patchpoint = ENABLE_ICDELATTRS && !info.isInterpreted();
@@ -368,7 +368,7 @@ ConcreteCompilerType* UNKNOWN = new UnknownType();
 
 CompilerVariable* UnknownType::getattr(IREmitter& emitter, const OpInfo& info, ConcreteCompilerVariable* var,
                                        const std::string* attr, bool cls_only) {
-    llvm::Constant* ptr = getStringConstantPtr(*attr + '\0');
+    llvm::Constant* ptr = embedConstantPtr(internAttrName(*attr), g.llvm_str_type_ptr);
 
     llvm::Value* rtn_val = NULL;
 
@@ -565,7 +565,7 @@ CompilerVariable* UnknownType::callattr(IREmitter& emitter, const OpInfo& info,
 
     std::vector<llvm::Value*> other_args;
     other_args.push_back(var->getValue());
-    other_args.push_back(embedConstantPtr(attr, g.llvm_str_type_ptr));
+    other_args.push_back(embedConstantPtr(internAttrName(*attr), g.llvm_str_type_ptr));
     other_args.push_back(getConstantInt(clsonly, g.i1));
 
     llvm::Value* llvm_argspec = llvm::ConstantInt::get(g.i32, argspec.asInt(), false);
@@ -1148,7 +1148,7 @@ private:
     KnownClassobjType(BoxedClass* cls) : cls(cls) { assert(cls); }
 
 public:
-    virtual std::string debugName() { return "class '" + *getNameOfClass(cls) + "'"; }
+    virtual std::string debugName() { return "class '" + std::string(getNameOfClass(cls)) + "'"; }
 
     static KnownClassobjType* fromClass(BoxedClass* cls) {
         KnownClassobjType*& rtn = made[cls];
@@ -1184,7 +1184,7 @@ private:
 
     NormalObjectType(BoxedClass* cls) : cls(cls) {
         // ASSERT(!isUserDefined(cls) && "instances of user-defined classes can change their __class__, plus even if
-        // they couldn't we couldn't statically resolve their attributes", "%s", getNameOfClass(cls)->c_str());
+        // they couldn't we couldn't statically resolve their attributes", "%s", getNameOfClass(cls));
 
         assert(cls);
     }
@@ -1195,7 +1195,7 @@ public:
         assert(cls);
         // TODO add getTypeName
 
-        return "NormalType(" + *getNameOfClass(cls) + ")";
+        return "NormalType(" + std::string(getNameOfClass(cls)) + ")";
     }
     virtual ConcreteCompilerVariable* makeConverted(IREmitter& emitter, ConcreteCompilerVariable* var,
                                                     ConcreteCompilerType* other_type) {
@@ -1243,7 +1243,7 @@ public:
             Box* rtattr = cls->getattr(*attr);
             if (rtattr == NULL) {
                 llvm::CallSite call = emitter.createCall2(info.exc_info, g.funcs.raiseAttributeErrorStr,
-                                                          getStringConstantPtr(*getNameOfClass(cls) + "\0"),
+                                                          getStringConstantPtr(std::string(getNameOfClass(cls)) + "\0"),
                                                           getStringConstantPtr(*attr + '\0'));
                 call.setDoesNotReturn();
                 return undefVariable();
@@ -1297,7 +1297,7 @@ public:
         if (rtattr == NULL) {
             if (raise_on_missing) {
                 llvm::CallSite call = emitter.createCall2(info.exc_info, g.funcs.raiseAttributeErrorStr,
-                                                          getStringConstantPtr(*getNameOfClass(cls) + "\0"),
+                                                          getStringConstantPtr(std::string(getNameOfClass(cls)) + "\0"),
                                                           getStringConstantPtr(*attr + '\0'));
                 call.setDoesNotReturn();
                 return undefVariable();
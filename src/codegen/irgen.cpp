@@ -73,12 +73,30 @@ static void addIRDebugSymbols(llvm::Function* f) {
     mpm.run(*g.cur_module);
 }
 
+static int countInstructions(llvm::Function* f) {
+    int rtn = 0;
+    for (llvm::BasicBlock& bb : *f) {
+        rtn += bb.size();
+    }
+    return rtn;
+}
+
+// Note: this runs serially on the compiling thread.  Running independent compiles in parallel
+// would need each worker to have its own LLVMContext, but all of our types (g.i64, g.llvm_value_type_ptr, etc)
+// and the JIT listeners are tied to g.context and g.engine, and compilation happens under the GIL.
+// The instruction counts logged here are meant for measuring how much of the compile time goes to
+// this function, and how that scales with function size.
 static void optimizeIR(llvm::Function* f, EffortLevel::EffortLevel effort) {
     // TODO maybe should do some simple passes (ex: gvn?) if effort level isn't maximal?
     // In general, this function needs a lot of tuning.
     if (effort < EffortLevel::MAXIMAL)
         return;
 
+    // The instruction counts are taken outside of the timed region, so that they don't show up in
+    // us_compiling_optimizing:
+    static StatCounter num_insts_before("num_optimizing_insts_before");
+    num_insts_before.log(countInstructions(f));
+
     Timer _t("optimizing");
 
     llvm::FunctionPassManager fpm(g.cur_module);
@@ -198,6 +216,11 @@ static void optimizeIR(llvm::Function* f, EffortLevel::EffortLevel effort) {
     long us = _t.end();
     static StatCounter us_optimizing("us_compiling_optimizing");
     us_optimizing.log(us);
+    static StatCounter num_optimized("num_compiling_optimized");
+    num_optimized.log();
+
+    static StatCounter num_insts_after("num_optimizing_insts_after");
+    num_insts_after.log(countInstructions(f));
 }
 
 static bool compareBlockPairs(const std::pair<CFGBlock*, CFGBlock*>& p1, const std::pair<CFGBlock*, CFGBlock*>& p2) {
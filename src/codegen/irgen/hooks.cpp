@@ -58,6 +58,15 @@ SourceInfo::ArgNames::ArgNames(AST* ast) {
     } else {
         RELEASE_ASSERT(0, "%d", ast->type);
     }
+
+    if (args) {
+        for (AST_expr* e : *args) {
+            if (e->type == AST_TYPE::Name)
+                interned_args.push_back(internAttrName(ast_cast<AST_Name>(e)->id));
+            else
+                interned_args.push_back(NULL);
+        }
+    }
 }
 
 const std::string SourceInfo::getName() {
@@ -283,6 +292,33 @@ static CompiledFunction* _doReopt(CompiledFunction* cf, EffortLevel::EffortLevel
 }
 
 static StatCounter stat_osrexits("OSR exits");
+static StatCounter stat_osrexits_reused("OSR exits reused");
+
+// Every OSR exit gets its own entry descriptor, but exits from different versions of the same function
+// (ex the interpreted version and its reoptimized replacement) often target the same backedge with the
+// same live variables.  In that case the partial function we compiled for one of them works for the other,
+// so reuse it instead of growing the code cache with another copy.
+// The partial function gets compiled against the specialization of the version we're exiting from, so
+// that has to match too, argument types included.
+static CompiledFunction* findCompatibleOSRVersion(CLFunction* clfunc, OSRExit* exit,
+                                                  EffortLevel::EffortLevel min_effort) {
+    const OSREntryDescriptor* entry = exit->entry;
+    const FunctionSpecialization* spec = exit->parent_cf->spec;
+    for (const auto& p : clfunc->osr_versions) {
+        CompiledFunction* cf = p.second;
+        if (cf == NULL || p.first == entry)
+            continue;
+        if (p.first->backedge != entry->backedge || p.first->args != entry->args)
+            continue;
+        if (cf->spec->rtn_type != spec->rtn_type || cf->spec->arg_types != spec->arg_types)
+            continue;
+        if (cf->effort < min_effort)
+            continue;
+        return cf;
+    }
+    return NULL;
+}
+
 void* compilePartialFunc(OSRExit* exit) {
     LOCK_REGION(codegen_rwlock.asWrite());
 
@@ -294,11 +330,19 @@ void* compilePartialFunc(OSRExit* exit) {
     // if (VERBOSITY("irgen") >= 1) printf("In compilePartialFunc, handling %p\n", exit);
 
     assert(exit->parent_cf->clfunc);
-    CompiledFunction*& new_cf = exit->parent_cf->clfunc->osr_versions[exit->entry];
+    CLFunction* clfunc = exit->parent_cf->clfunc;
+    CompiledFunction*& new_cf = clfunc->osr_versions[exit->entry];
     if (new_cf == NULL) {
         EffortLevel::EffortLevel new_effort = EffortLevel::MAXIMAL;
         if (exit->parent_cf->effort == EffortLevel::INTERPRETED)
             new_effort = EffortLevel::MINIMAL;
+
+        new_cf = findCompatibleOSRVersion(clfunc, exit, new_effort);
+        if (new_cf) {
+            stat_osrexits_reused.log();
+            return new_cf->code;
+        }
+
         // EffortLevel::EffortLevel new_effort = (EffortLevel::EffortLevel)(exit->parent_cf->effort + 1);
         // new_effort = EffortLevel::MAXIMAL;
         CompiledFunction* compiled
@@ -484,10 +484,11 @@ private:
 
             // Only add the keywords to the array the first time, since
             // the later times we will hit the cache which will have the
-            // keyword names already populated:
+            // keyword names already populated.
+            // The names are interned so that callFunc can match them to parameters by pointer.
             if (!keyword_names->size()) {
                 for (auto kw : node->keywords) {
-                    keyword_names->push_back(&kw->arg);
+                    keyword_names->push_back(internAttrName(kw->arg));
                 }
             }
         } else {
@@ -632,7 +633,7 @@ private:
 
             std::vector<llvm::Value*> llvm_args;
             llvm_args.push_back(embedConstantPtr(irstate->getSourceInfo()->parent_module, g.llvm_module_type_ptr));
-            llvm_args.push_back(embedConstantPtr(&node->id, g.llvm_str_type_ptr));
+            llvm_args.push_back(embedConstantPtr(internAttrName(node->id), g.llvm_str_type_ptr));
 
             llvm::Value* uncasted
                 = emitter.createPatchpoint(pp, (void*)pyston::getGlobal, llvm_args, exc_info).getInstruction();
@@ -642,7 +643,7 @@ private:
             llvm::Value* r
                 = emitter.createCall2(exc_info, g.funcs.getGlobal,
                                       embedConstantPtr(irstate->getSourceInfo()->parent_module, g.llvm_module_type_ptr),
-                                      embedConstantPtr(&node->id, g.llvm_str_type_ptr)).getInstruction();
+                                      embedConstantPtr(internAttrName(node->id), g.llvm_str_type_ptr)).getInstruction();
             return new ConcreteCompilerVariable(UNKNOWN, r, true);
         }
     }
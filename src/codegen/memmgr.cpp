@@ -21,6 +21,7 @@
 #include "llvm/Support/Memory.h"
 
 #include "core/common.h"
+#include "core/stats.h"
 #include "core/util.h"
 
 // This code was copy-pasted from SectionMemoryManager.cpp;
@@ -49,9 +50,15 @@ private:
         SmallVector<sys::MemoryBlock, 16> AllocatedMem;
         SmallVector<sys::MemoryBlock, 16> FreeMem;
         sys::MemoryBlock Near;
+
+        // pyston: we finalize once per compiled function, so only the blocks past this index
+        // still need to have their permissions set.
+        unsigned NumFinalized;
+
+        MemoryGroup() : NumFinalized(0) {}
     };
 
-    uint8_t* allocateSection(MemoryGroup& MemGroup, uintptr_t Size, unsigned Alignment);
+    uint8_t* allocateSection(MemoryGroup& MemGroup, uintptr_t Size, unsigned Alignment, StatCounter& bytes_used);
 
     error_code applyMemoryGroupPermissions(MemoryGroup& MemGroup, unsigned Permissions);
 
@@ -66,23 +73,29 @@ uint8_t* PystonMemoryManager::allocateDataSection(uintptr_t Size, unsigned Align
                                                   StringRef SectionName, bool IsReadOnly) {
     // printf("allocating data section: %ld %d %d %s %d\n", Size, Alignment, SectionID, SectionName.data(), IsReadOnly);
     // assert(SectionName != ".llvm_stackmaps");
+    static StatCounter rodata_bytes("jit_rodata_bytes");
+    static StatCounter rwdata_bytes("jit_rwdata_bytes");
     if (IsReadOnly)
-        return allocateSection(RODataMem, Size, Alignment);
-    return allocateSection(RWDataMem, Size, Alignment);
+        return allocateSection(RODataMem, Size, Alignment, rodata_bytes);
+    return allocateSection(RWDataMem, Size, Alignment, rwdata_bytes);
 }
 
 uint8_t* PystonMemoryManager::allocateCodeSection(uintptr_t Size, unsigned Alignment, unsigned SectionID,
                                                   StringRef SectionName) {
     // printf("allocating code section: %ld %d %d %s\n", Size, Alignment, SectionID, SectionName.data());
-    return allocateSection(CodeMem, Size, Alignment);
+    static StatCounter code_bytes("jit_code_bytes");
+    return allocateSection(CodeMem, Size, Alignment, code_bytes);
 }
 
-uint8_t* PystonMemoryManager::allocateSection(MemoryGroup& MemGroup, uintptr_t Size, unsigned Alignment) {
+uint8_t* PystonMemoryManager::allocateSection(MemoryGroup& MemGroup, uintptr_t Size, unsigned Alignment,
+                                              StatCounter& bytes_used) {
     if (!Alignment)
         Alignment = 16;
 
     assert(!(Alignment & (Alignment - 1)) && "Alignment must be a power of two.");
 
+    bytes_used.log(Size);
+
     uintptr_t RequiredSize = Alignment * ((Size + Alignment - 1) / Alignment + 1);
     uintptr_t Addr = 0;
 
@@ -121,6 +134,9 @@ uint8_t* PystonMemoryManager::allocateSection(MemoryGroup& MemGroup, uintptr_t S
     // Save this address as the basis for our next request
     MemGroup.Near = MB;
 
+    static StatCounter mapped_bytes("jit_mapped_bytes");
+    mapped_bytes.log(MB.size());
+
     MemGroup.AllocatedMem.push_back(MB);
     Addr = (uintptr_t)MB.base();
     uintptr_t EndOfBlock = Addr + MB.size();
@@ -142,8 +158,9 @@ bool PystonMemoryManager::finalizeMemory(std::string* ErrMsg) {
     // FIXME: Should in-progress permissions be reverted if an error occurs?
     error_code ec;
 
-    // Don't allow free memory blocks to be used after setting protection flags.
-    CodeMem.FreeMem.clear();
+    // pyston: since code memory stays writeable (see below), setting the protection flags doesn't stop
+    // us from handing out the rest of a partially-used block.  Keeping the free blocks around means that
+    // each compiled function doesn't burn its own fresh page of code memory.
 
     // Make code memory executable.
     // pyston: also make it writeable so we can patch it later
@@ -179,13 +196,14 @@ bool PystonMemoryManager::finalizeMemory(std::string* ErrMsg) {
 
 error_code PystonMemoryManager::applyMemoryGroupPermissions(MemoryGroup& MemGroup, unsigned Permissions) {
 
-    for (int i = 0, e = MemGroup.AllocatedMem.size(); i != e; ++i) {
+    for (int i = MemGroup.NumFinalized, e = MemGroup.AllocatedMem.size(); i != e; ++i) {
         error_code ec;
         ec = sys::Memory::protectMappedMemory(MemGroup.AllocatedMem[i], Permissions);
         if (ec) {
             return ec;
         }
     }
+    MemGroup.NumFinalized = MemGroup.AllocatedMem.size();
 
 #if LLVMREV < 209952
     return error_code::success();
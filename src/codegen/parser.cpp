@@ -19,6 +19,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <stdint.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 
 #include "llvm/Support/FileSystem.h"
@@ -39,6 +40,8 @@ class BufferedReader {
 private:
     static const int BUFSIZE = 1024;
     char buf[BUFSIZE];
+    // Points either to buf, or to an externally-owned (ex mmap'd) region if we're not reading from fp:
+    const char* data;
     int start, end;
     FILE* fp;
 
@@ -50,6 +53,10 @@ private:
 
 public:
     void fill() {
+        // When reading from memory, everything is already buffered:
+        if (!fp)
+            return;
+
         memmove(buf, buf + start, end - start);
         end -= start;
         start = 0;
@@ -58,7 +65,8 @@ public:
             printf("filled, now at %d-%d\n", start, end);
     }
 
-    BufferedReader(FILE* fp) : start(0), end(0), fp(fp) {}
+    BufferedReader(FILE* fp) : data(buf), start(0), end(0), fp(fp) {}
+    BufferedReader(const char* data, int size) : data(data), start(0), end(size), fp(NULL) {}
 
     int bytesBuffered() { return (end - start); }
 
@@ -67,7 +75,7 @@ public:
         assert(end > start && "premature eof");
         if (VERBOSITY("parsing") >= 2)
             printf("readByte, now %d %d\n", start + 1, end);
-        return buf[start++];
+        return data[start++];
     }
     uint16_t readShort() { return (readByte() << 8) | (readByte()); }
     uint32_t readUInt() { return (readShort() << 16) | (readShort()); }
@@ -88,11 +96,12 @@ AST_stmt* readASTStmt(BufferedReader* reader);
 
 static std::string readString(BufferedReader* reader) {
     int strlen = reader->readShort();
-    std::vector<char> chars;
+    std::string rtn;
+    rtn.reserve(strlen);
     for (int i = 0; i < strlen; i++) {
-        chars.push_back(reader->readByte());
+        rtn.push_back(reader->readByte());
     }
-    return std::string(chars.begin(), chars.end());
+    return rtn;
 }
 
 static void readStringVector(std::vector<std::string>& vec, BufferedReader* reader) {
@@ -957,6 +966,8 @@ static void _reparse(const char* fn, const std::string& cache_fn) {
 // Parsing the file is somewhat expensive since we have to shell out to cpython;
 // it's not a huge deal right now, but this caching version can significantly cut down
 // on the startup time (40ms -> 10ms).
+// The cache file gets mmap'd and deserialized in place, so that workers that repeatedly import
+// the same modules share the page cache and don't pay for copying the file through stdio.
 AST_Module* caching_parse(const char* fn) {
     Timer _t("parsing");
 
@@ -977,6 +988,7 @@ AST_Module* caching_parse(const char* fn) {
     FILE* fp = fopen(cache_fn.c_str(), "r");
     assert(fp);
 
+    int length = 0;
     while (true) {
         bool good = true;
 
@@ -992,7 +1004,7 @@ AST_Module* caching_parse(const char* fn) {
         }
 
         if (good) {
-            int length = 0;
+            length = 0;
             fseek(fp, MAGIC_STRING_LENGTH, SEEK_SET);
             static_assert(sizeof(length) >= CHECKSUM_LENGTH, "");
             int read = fread(&length, 1, CHECKSUM_LENGTH, fp);
@@ -1020,12 +1032,20 @@ AST_Module* caching_parse(const char* fn) {
         }
     }
 
-    BufferedReader* reader = new BufferedReader(fp);
+    void* mapped = mmap(NULL, cache_stat.st_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+    RELEASE_ASSERT(mapped != MAP_FAILED, "failed to mmap %s", cache_fn.c_str());
+    fclose(fp);
+
+    BufferedReader* reader
+        = new BufferedReader((const char*)mapped + MAGIC_STRING_LENGTH + CHECKSUM_LENGTH, length);
     AST* rtn = readASTMisc(reader);
-    reader->fill();
     assert(reader->bytesBuffered() == 0);
     delete reader;
 
+    // Everything we read got copied into the AST, so the mapping can go away now:
+    code = munmap(mapped, cache_stat.st_size);
+    assert(code == 0);
+
     assert(rtn->type == AST_TYPE::Module);
 
     long us = _t.end();
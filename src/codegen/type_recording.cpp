@@ -14,6 +14,7 @@
 
 #include "codegen/type_recording.h"
 
+#include <algorithm>
 #include <unordered_map>
 
 #include "core/options.h"
@@ -29,16 +30,49 @@ TypeRecorder* getTypeRecorderForNode(AST* node) {
     return r;
 }
 
+// Don't trust a prediction until the site has been hit this many times:
+static const int64_t MIN_OBSERVATIONS = 100;
+// Classes that make up less than this percentage of the observations are treated as noise: predict()
+// only picks a class if everything else put together is below it, and predictAll() leaves them out.
+static const int64_t NOISE_PERCENT = 1;
+// Once a site has been hit this many times, halve all of its counts so that the
+// histogram follows phase changes in the program:
+static const int64_t DECAY_THRESHOLD = 1 << 14;
+
 Box* recordType(TypeRecorder* self, Box* obj) {
     BoxedClass* cls = obj->cls;
-    if (cls != self->last_seen) {
-        self->last_seen = cls;
-        self->last_count = 1;
-    } else {
-        self->last_count++;
+
+    int idx = 0;
+    while (idx < TypeRecorder::NUM_TRACKED && self->seen[idx] != cls && self->seen[idx] != NULL)
+        idx++;
+
+    if (idx == TypeRecorder::NUM_TRACKED) {
+        // Evict the least-frequently seen class.  Its observations stay in total, so that the classes
+        // we still track don't look more dominant than they really are:
+        idx = TypeRecorder::NUM_TRACKED - 1;
+        self->seen[idx] = cls;
+        self->counts[idx] = 0;
+    } else if (self->seen[idx] == NULL) {
+        self->seen[idx] = cls;
+    }
+
+    self->counts[idx]++;
+    self->total++;
+
+    // Bubble the entry up to keep the histogram sorted:
+    while (idx > 0 && self->counts[idx] > self->counts[idx - 1]) {
+        std::swap(self->seen[idx], self->seen[idx - 1]);
+        std::swap(self->counts[idx], self->counts[idx - 1]);
+        idx--;
+    }
+
+    if (self->total >= DECAY_THRESHOLD) {
+        self->total /= 2;
+        for (int i = 0; i < TypeRecorder::NUM_TRACKED; i++)
+            self->counts[i] /= 2;
     }
 
-    // printf("Seen %s %ld times\n", getNameOfClass(cls)->c_str(), self->last_count);
+    // printf("Seen %s %ld times\n", getNameOfClass(cls), self->counts[idx]);
 
     return obj;
 }
@@ -52,13 +86,38 @@ BoxedClass* predictClassFor(AST* node) {
     return r->predict();
 }
 
+std::vector<BoxedClass*> predictClassesFor(AST* node) {
+    auto it = type_recorders.find(node);
+    if (it == type_recorders.end())
+        return std::vector<BoxedClass*>();
+
+    TypeRecorder* r = it->second;
+    return r->predictAll();
+}
+
 BoxedClass* TypeRecorder::predict() {
     if (!ENABLE_TYPE_FEEDBACK)
         return NULL;
 
-    if (last_count > 100)
-        return last_seen;
+    if (total > MIN_OBSERVATIONS && counts[0] * 100 >= total * (100 - NOISE_PERCENT))
+        return seen[0];
 
     return NULL;
 }
+
+std::vector<BoxedClass*> TypeRecorder::predictAll() {
+    std::vector<BoxedClass*> rtn;
+    if (!ENABLE_TYPE_FEEDBACK)
+        return rtn;
+
+    if (total <= MIN_OBSERVATIONS)
+        return rtn;
+
+    for (int i = 0; i < NUM_TRACKED; i++) {
+        if (seen[i] == NULL || counts[i] * 100 < total * NOISE_PERCENT)
+            break;
+        rtn.push_back(seen[i]);
+    }
+    return rtn;
+}
 }
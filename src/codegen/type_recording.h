@@ -16,6 +16,7 @@
 #define PYSTON_CODEGEN_TYPERECORDING_H
 
 #include <cstdint>
+#include <vector>
 
 namespace pyston {
 
@@ -32,14 +33,27 @@ class TypeRecorder;
 // specified.)
 extern "C" Box* recordType(TypeRecorder* recorder, Box* obj);
 class TypeRecorder {
+public:
+    // How many distinct classes we keep counts for at each site.
+    static const int NUM_TRACKED = 4;
+
 private:
-    BoxedClass* last_seen;
-    int64_t last_count;
+    // A small histogram of the classes seen at this site, kept sorted by count so that
+    // the most frequently-seen class is first.  A class that isn't in the histogram
+    // replaces the least-frequently-seen entry.
+    BoxedClass* seen[NUM_TRACKED];
+    int64_t counts[NUM_TRACKED];
+    // Every observation, including those of classes that have since been evicted.
+    int64_t total;
 
 public:
-    constexpr TypeRecorder() : last_seen(nullptr), last_count(0) {}
+    constexpr TypeRecorder() : seen(), counts(), total(0) {}
 
+    // Returns the class that has made up nearly all of the observations, or NULL.
     BoxedClass* predict();
+    // Returns the classes that each made up a non-trivial fraction of the observations,
+    // most frequently-seen first.  Empty if there haven't been enough observations yet.
+    std::vector<BoxedClass*> predictAll();
 
     friend Box* recordType(TypeRecorder*, Box*);
 };
@@ -47,6 +61,7 @@ public:
 TypeRecorder* getTypeRecorderForNode(AST* node);
 
 BoxedClass* predictClassFor(AST* node);
+std::vector<BoxedClass*> predictClassesFor(AST* node);
 }
 
 #endif
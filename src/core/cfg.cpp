@@ -1817,7 +1817,7 @@ CFG* computeCFG(SourceInfo* source, std::vector<AST_stmt*> body) {
         assert(module_name->cls == str_cls);
         AST_Assign* module_assign = new AST_Assign();
         module_assign->targets.push_back(makeName("__module__", AST_TYPE::Store));
-        module_assign->value = new AST_Str(static_cast<BoxedString*>(module_name)->s);
+        module_assign->value = new AST_Str(static_cast<BoxedString*>(module_name)->s.str());
         module_assign->lineno = 0;
         visitor.push_back(module_assign);
 
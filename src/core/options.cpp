@@ -29,6 +29,7 @@ bool SHOW_DISASM = false;
 bool BENCH = false;
 bool PROFILE = false;
 bool DUMPJIT = false;
+bool DUMP_ICS = false;
 bool TRAP = false;
 bool USE_STRIPPED_STDLIB = false;
 bool ENABLE_INTERPRETER = true;
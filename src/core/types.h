@@ -187,6 +187,9 @@ public:
     struct ArgNames {
         const std::vector<AST_expr*>* args;
         const std::string* vararg, *kwarg;
+        // The interned names of the parameters in args, or NULL for parameters that aren't
+        // plain names (ie tuple-unpacking ones), so that keywords can be matched by pointer:
+        std::vector<const std::string*> interned_args;
 
         explicit ArgNames(AST* ast);
 
@@ -274,7 +277,7 @@ EffortLevel::EffortLevel initialEffort();
 typedef bool i1;
 typedef int64_t i64;
 
-extern "C" const std::string* getNameOfClass(BoxedClass* cls);
+extern "C" const char* getNameOfClass(BoxedClass* cls);
 
 class Rewriter;
 class RewriterVar;
@@ -354,6 +357,14 @@ public:
     AttrList* attr_list;
 
     HCAttrs() : hcls(root_hcls), attr_list(nullptr) {}
+    HCAttrs(HiddenClass* hcls) : hcls(hcls), attr_list(nullptr) {}
+
+    // Objects whose hidden class has num_inline > 0 store their first attributes directly
+    // after the HCAttrs, rather than behind the extra indirection of the attr_list.
+    Box** getInlineAttrs() { return reinterpret_cast<Box**>(this + 1); }
+    // Returns the location of the attribute at the given hidden-class offset.
+    // Defined in runtime/types.h
+    Box** getSlot(int offset);
 };
 
 class Box : public PythonGCObject {
@@ -376,7 +387,7 @@ public:
     Box* getattr(const std::string& attr) { return getattr(attr, NULL); }
     void delattr(const std::string& attr, DelattrRewriteArgs* rewrite_args);
 };
-extern "C" const std::string* getTypeName(Box* o);
+extern "C" const char* getTypeName(Box* o);
 
 
 
@@ -416,6 +427,15 @@ public:
     // this is used mostly for debugging.
     const bool is_user_defined;
 
+    // How many attribute slots to allocate inside new instances, based on the number of attributes
+    // that previous instances have ended up with.  Only used for classes whose HCAttrs comes at
+    // the end of the instance; see canHaveInlineAttrs().
+    int num_inline_attrs;
+
+    bool canHaveInlineAttrs() {
+        return is_user_defined && attrs_offset && attrs_offset + sizeof(HCAttrs) == tp_basicsize;
+    }
+
     // will need to update this once we support tp_getattr-style overriding:
     bool hasGenericGetattr() { return true; }
 
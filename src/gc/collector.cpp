@@ -65,7 +65,18 @@ StaticRootHandle::~StaticRootHandle() {
     getRootHandles()->erase(this);
 }
 
+static std::vector<WeakRefClearer>* getWeakRefClearers() {
+    static std::vector<WeakRefClearer> weak_ref_clearers;
+    return &weak_ref_clearers;
+}
+
+void registerWeakRefClearer(WeakRefClearer clearer) {
+    getWeakRefClearers()->push_back(clearer);
+}
 
+bool isReachable(void* p) {
+    return isMarked(GCAllocation::fromUserData(p));
+}
 
 bool TraceStackGCVisitor::isValid(void* p) {
     return global_heap.getAllocationFromInteriorPointer(p) != NULL;
@@ -149,7 +160,7 @@ static void markPhase() {
                 // An arbitrary amount of stuff can happen between the 'new' and
                 // the call to the constructor (ie the args get evaluated), which
                 // can trigger a collection.
-                ASSERT(cls->gc_visit, "%s", getTypeName(b)->c_str());
+                ASSERT(cls->gc_visit, "%s", getTypeName(b));
                 cls->gc_visit(&visitor, b);
             }
         } else {
@@ -162,6 +173,11 @@ static void markPhase() {
 #endif
 }
 
+static void clearWeakRefs() {
+    for (WeakRefClearer clearer : *getWeakRefClearers())
+        clearer();
+}
+
 static void sweepPhase() {
     global_heap.freeUnmarked();
 }
@@ -179,6 +195,7 @@ void runCollection() {
     Timer _t("collecting", /*min_usec=*/10000);
 
     markPhase();
+    clearWeakRefs();
     sweepPhase();
     if (VERBOSITY("gc") >= 2)
         printf("Collection #%d done\n\n", ncollections);
@@ -69,6 +69,13 @@ void registerStaticRootObj(void* root_obj);
 void registerStaticRootMemory(void* start, void* end);
 void runCollection();
 
+// Weak references: a weak reference clearer gets called at the end of the mark phase, before
+// anything gets freed, and should drop any references it holds to objects that didn't get marked.
+typedef void (*WeakRefClearer)();
+void registerWeakRefClearer(WeakRefClearer clearer);
+// Whether the object survives the current collection; only meaningful inside a WeakRefClearer.
+bool isReachable(void* p);
+
 // If you want to have a static root "location" where multiple values could be stored, use this:
 class StaticRootHandle {
 public:
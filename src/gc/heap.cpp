@@ -396,7 +396,7 @@ static void _doFree(GCAllocation* al) {
 
     if (al->kind_id == GCKind::PYTHON) {
         Box* b = (Box*)al->user_data;
-        ASSERT(b->cls->tp_dealloc == NULL, "%s", getTypeName(b)->c_str());
+        ASSERT(b->cls->tp_dealloc == NULL, "%s", getTypeName(b));
     }
 }
 
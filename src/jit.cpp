@@ -27,6 +27,7 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Signals.h"
 
+#include "asm_writing/icinfo.h"
 #include "codegen/entry.h"
 #include "codegen/irgen/hooks.h"
 #include "codegen/parser.h"
@@ -57,7 +58,7 @@ int main(int argc, char** argv) {
     bool force_repl = false;
     bool repl = true;
     bool stats = false;
-    while ((code = getopt(argc, argv, "+Oqcdibpjtrsvn")) != -1) {
+    while ((code = getopt(argc, argv, "+OqcdibpjItrsvn")) != -1) {
         if (code == 'O')
             FORCE_OPTIMIZE = true;
         else if (code == 't')
@@ -80,6 +81,8 @@ int main(int argc, char** argv) {
             PROFILE = true;
         } else if (code == 'j') {
             DUMPJIT = true;
+        } else if (code == 'I') {
+            DUMP_ICS = true;
         } else if (code == 's') {
             stats = true;
         } else if (code == 'r') {
@@ -273,6 +276,9 @@ int main(int argc, char** argv) {
 
     threading::finishMainThread();
 
+    if (DUMP_ICS)
+        dumpICStats(20);
+
     _t.split("joinRuntime");
 
     int rtncode = joinRuntime();
@@ -66,13 +66,13 @@ extern "C" Box* dir(Box* obj) {
         result = new BoxedList();
     }
 
-    for (auto const& kv : obj->cls->attrs.hcls->attr_offsets) {
-        listAppend(result, boxString(kv.first));
+    for (const std::string* name : obj->cls->attrs.hcls->getAttrNames()) {
+        listAppend(result, boxString(*name));
     }
     if (obj->cls->instancesHaveAttrs()) {
         HCAttrs* attrs = obj->getAttrsPtr();
-        for (auto const& kv : attrs->hcls->attr_offsets) {
-            listAppend(result, boxString(kv.first));
+        for (const std::string* name : attrs->hcls->getAttrNames()) {
+            listAppend(result, boxString(*name));
         }
     }
     return result;
@@ -86,7 +86,7 @@ extern "C" Box* abs_(Box* x) {
         double d = static_cast<BoxedFloat*>(x)->d;
         return boxFloat(d >= 0 ? d : -d);
     } else {
-        RELEASE_ASSERT(0, "%s", getTypeName(x)->c_str());
+        RELEASE_ASSERT(0, "%s", getTypeName(x));
     }
 }
 
@@ -185,28 +185,46 @@ extern "C" Box* id(Box* arg) {
 }
 
 
-Box* open(Box* arg1, Box* arg2) {
+Box* open(Box* arg1, Box* arg2, Box* arg3) {
     assert(arg2);
+    assert(arg3);
 
     if (arg1->cls != str_cls) {
         fprintf(stderr, "TypeError: coercing to Unicode: need string of buffer, %s found\n",
-                getTypeName(arg1)->c_str());
+                getTypeName(arg1));
         raiseExcHelper(TypeError, "");
     }
     if (arg2->cls != str_cls) {
         fprintf(stderr, "TypeError: coercing to Unicode: need string of buffer, %s found\n",
-                getTypeName(arg2)->c_str());
+                getTypeName(arg2));
         raiseExcHelper(TypeError, "");
     }
 
-    const std::string& fn = static_cast<BoxedString*>(arg1)->s;
-    const std::string& mode = static_cast<BoxedString*>(arg2)->s;
+    const char* fn = static_cast<BoxedString*>(arg1)->c_str();
+    const char* mode = static_cast<BoxedString*>(arg2)->c_str();
 
-    FILE* f = fopen(fn.c_str(), mode.c_str());
-    if (!f)
-        raiseExcHelper(IOError, "%s: '%s' '%s'", strerror(errno), fn.c_str());
+    if (arg3->cls != int_cls)
+        raiseExcHelper(TypeError, "an integer is required");
+    // Same meaning as for CPython: 0 is unbuffered, 1 is line buffered, negative is the default.
+    i64 buffering = static_cast<BoxedInt*>(arg3)->n;
 
-    return new BoxedFile(f);
+    FILE* f = fopen(fn, mode);
+    if (!f)
+        raiseExcHelper(IOError, "%s: '%s' '%s'", strerror(errno), fn);
+
+    BoxedFile* rtn = new BoxedFile(f);
+    if (buffering == 0) {
+        setvbuf(f, NULL, _IONBF, 0);
+    } else if (buffering == 1) {
+        setvbuf(f, NULL, _IOLBF, 0);
+    } else if (buffering > 1) {
+        // glibc ignores the size unless we pass in the buffer ourselves.  stdio can still touch the
+        // buffer when it flushes everything at exit, so it has to outlive the FILE and can't come from
+        // the GC heap; it gets freed in fileClose(), and only files that ask for it pay for it.
+        rtn->io_buf = (char*)malloc(buffering);
+        setvbuf(f, rtn->io_buf, _IOFBF, buffering);
+    }
+    return rtn;
 }
 
 extern "C" Box* chr(Box* arg) {
@@ -218,14 +236,21 @@ extern "C" Box* chr(Box* arg) {
         raiseExcHelper(ValueError, "chr() arg not in range(256)");
     }
 
-    return boxString(std::string(1, (char)n));
+    char c = (char)n;
+    return internString(llvm::StringRef(&c, 1));
+}
+
+Box* intern_func(Box* str) {
+    if (str->cls != str_cls)
+        raiseExcHelper(TypeError, "intern() argument 1 must be string, not %s", getTypeName(str));
+    return internString(static_cast<BoxedString*>(str));
 }
 
 extern "C" Box* ord(Box* arg) {
     if (arg->cls != str_cls) {
-        raiseExcHelper(TypeError, "ord() expected string of length 1, but %s found", getTypeName(arg)->c_str());
+        raiseExcHelper(TypeError, "ord() expected string of length 1, but %s found", getTypeName(arg));
     }
-    const std::string& s = static_cast<BoxedString*>(arg)->s;
+    llvm::StringRef s = static_cast<BoxedString*>(arg)->s;
 
     if (s.size() != 1)
         raiseExcHelper(TypeError, "ord() expected string of length 1, but string of length %d found", s.size());
@@ -236,22 +261,22 @@ extern "C" Box* ord(Box* arg) {
 Box* range(Box* start, Box* stop, Box* step) {
     i64 istart, istop, istep;
     if (stop == NULL) {
-        RELEASE_ASSERT(start->cls == int_cls, "%s", getTypeName(start)->c_str());
+        RELEASE_ASSERT(start->cls == int_cls, "%s", getTypeName(start));
 
         istart = 0;
         istop = static_cast<BoxedInt*>(start)->n;
         istep = 1;
     } else if (step == NULL) {
-        RELEASE_ASSERT(start->cls == int_cls, "%s", getTypeName(start)->c_str());
-        RELEASE_ASSERT(stop->cls == int_cls, "%s", getTypeName(stop)->c_str());
+        RELEASE_ASSERT(start->cls == int_cls, "%s", getTypeName(start));
+        RELEASE_ASSERT(stop->cls == int_cls, "%s", getTypeName(stop));
 
         istart = static_cast<BoxedInt*>(start)->n;
         istop = static_cast<BoxedInt*>(stop)->n;
         istep = 1;
     } else {
-        RELEASE_ASSERT(start->cls == int_cls, "%s", getTypeName(start)->c_str());
-        RELEASE_ASSERT(stop->cls == int_cls, "%s", getTypeName(stop)->c_str());
-        RELEASE_ASSERT(step->cls == int_cls, "%s", getTypeName(step)->c_str());
+        RELEASE_ASSERT(start->cls == int_cls, "%s", getTypeName(start));
+        RELEASE_ASSERT(stop->cls == int_cls, "%s", getTypeName(stop));
+        RELEASE_ASSERT(step->cls == int_cls, "%s", getTypeName(step));
 
         istart = static_cast<BoxedInt*>(start)->n;
         istop = static_cast<BoxedInt*>(stop)->n;
@@ -280,33 +305,17 @@ Box* notimplementedRepr(Box* self) {
     return boxStrConstant("NotImplemented");
 }
 
-Box* sorted(Box* obj) {
-    BoxedList* rtn = new BoxedList();
-    for (Box* e : obj->pyElements()) {
-        listAppendInternal(rtn, e);
-    }
-
-    std::sort<Box**, PyLt>(rtn->elts->elts, rtn->elts->elts + rtn->size, PyLt());
-
-    return rtn;
-}
-
-Box* sortedList(Box* obj) {
-    RELEASE_ASSERT(obj->cls == list_cls, "");
-
-    BoxedList* lobj = static_cast<BoxedList*>(obj);
+Box* sorted(Box* obj, BoxedDict* kwargs) {
     BoxedList* rtn = new BoxedList();
-
-    int size = lobj->size;
-    rtn->elts = new (size) GCdArray();
-    rtn->size = size;
-    rtn->capacity = size;
-    for (int i = 0; i < size; i++) {
-        Box* t = rtn->elts->elts[i] = lobj->elts->elts[i];
+    if (obj->cls == list_cls) {
+        listIAdd(rtn, obj);
+    } else {
+        for (Box* e : obj->pyElements()) {
+            listAppendInternal(rtn, e);
+        }
     }
 
-    std::sort<Box**, PyLt>(rtn->elts->elts, rtn->elts->elts + size, PyLt());
-
+    listSort(rtn, kwargs);
     return rtn;
 }
 
@@ -331,14 +340,14 @@ Box* getattrFunc(Box* obj, Box* _str, Box* default_value) {
     }
 
     BoxedString* str = static_cast<BoxedString*>(_str);
-    Box* rtn = getattr_internal(obj, str->s, true, true, NULL);
+    Box* rtn = getattr_internal(obj, str->s.str(), true, true, NULL);
 
     if (!rtn) {
         if (default_value)
             return default_value;
         else
-            raiseExcHelper(AttributeError, "'%s' object has no attribute '%s'", getTypeName(obj)->c_str(),
-                           str->s.c_str());
+            raiseExcHelper(AttributeError, "'%s' object has no attribute '%s'", getTypeName(obj),
+                           str->c_str());
     }
 
     return rtn;
@@ -350,7 +359,7 @@ Box* hasattr(Box* obj, Box* _str) {
     }
 
     BoxedString* str = static_cast<BoxedString*>(_str);
-    Box* attr = getattr_internal(obj, str->s, true, true, NULL);
+    Box* attr = getattr_internal(obj, str->s.str(), true, true, NULL);
 
     Box* rtn = attr ? True : False;
     return rtn;
@@ -434,7 +443,7 @@ Box* exceptionRepr(Box* b) {
     assert(message->cls == str_cls);
 
     BoxedString* message_s = static_cast<BoxedString*>(message);
-    return boxString(*getTypeName(b) + "(" + message_s->s + ",)");
+    return boxString(std::string(getTypeName(b)) + "(" + message_s->s.str() + ",)");
 }
 
 static BoxedClass* makeBuiltinException(BoxedClass* base, const char* name) {
@@ -469,7 +478,7 @@ public:
         Box* iterator
             = callattrInternal(obj, &iter_name, CLASS_ONLY, NULL, ArgPassSpec(0), NULL, NULL, NULL, NULL, NULL);
         if (!iterator)
-            raiseNotIterableError(getTypeName(iterator)->c_str());
+            raiseNotIterableError(getTypeName(iterator));
         return new BoxedEnumerate(iterator, idx);
     }
 
@@ -500,7 +509,7 @@ public:
         BoxedEnumerate* self = static_cast<BoxedEnumerate*>(_self);
         Box* r = callattrInternal(self->iterator, &hasnext_name, CLASS_ONLY, NULL, ArgPassSpec(0), NULL, NULL, NULL,
                                   NULL, NULL);
-        RELEASE_ASSERT(r, "%s", getTypeName(self->iterator)->c_str());
+        RELEASE_ASSERT(r, "%s", getTypeName(self->iterator));
         return r;
     }
 
@@ -577,6 +586,7 @@ void setupBuiltins() {
     builtins_module->giveAttr("chr", chr_obj);
     ord_obj = new BoxedFunction(boxRTFunction((void*)ord, BOXED_INT, 1));
     builtins_module->giveAttr("ord", ord_obj);
+    builtins_module->giveAttr("intern", new BoxedFunction(boxRTFunction((void*)intern_func, STR, 1)));
     trap_obj = new BoxedFunction(boxRTFunction((void*)trap, UNKNOWN, 0));
     builtins_module->giveAttr("trap", trap_obj);
 
@@ -609,10 +619,8 @@ void setupBuiltins() {
     builtins_module->giveAttr("enumerate", enumerate_cls);
 
 
-    CLFunction* sorted_func = createRTFunction(1, 0, false, false);
-    addRTFunction(sorted_func, (void*)sortedList, LIST, { LIST });
-    addRTFunction(sorted_func, (void*)sorted, LIST, { UNKNOWN });
-    builtins_module->giveAttr("sorted", new BoxedFunction(sorted_func));
+    builtins_module->giveAttr("sorted",
+                              new BoxedFunction(boxRTFunction((void*)sorted, LIST, 1, 0, false, true)));
 
     builtins_module->giveAttr("True", True);
     builtins_module->giveAttr("False", False);
@@ -623,8 +631,8 @@ void setupBuiltins() {
     setupXrange();
     builtins_module->giveAttr("xrange", xrange_cls);
 
-    open_obj = new BoxedFunction(boxRTFunction((void*)open, typeFromClass(file_cls), 2, 1, false, false),
-                                 { boxStrConstant("r") });
+    open_obj = new BoxedFunction(boxRTFunction((void*)open, typeFromClass(file_cls), 3, 2, false, false),
+                                 { boxStrConstant("r"), boxInt(-1) });
     builtins_module->giveAttr("open", open_obj);
 
     builtins_module->giveAttr("map", new BoxedFunction(boxRTFunction((void*)map2, LIST, 2)));
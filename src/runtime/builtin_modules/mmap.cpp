@@ -0,0 +1,274 @@
+// Copyright (c) 2014 Dropbox, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "codegen/compvars.h"
+#include "core/types.h"
+#include "gc/collector.h"
+#include "runtime/objmodel.h"
+#include "runtime/types.h"
+#include "runtime/util.h"
+
+namespace pyston {
+
+BoxedModule* mmap_module;
+BoxedClass* mmap_cls;
+
+// Same values as CPython's
+static const int ACCESS_DEFAULT = 0, ACCESS_READ = 1, ACCESS_WRITE = 2, ACCESS_COPY = 3;
+
+static i64 unboxIntArg(Box* b, const char* name) {
+    if (b->cls != int_cls)
+        raiseExcHelper(TypeError, "mmap() argument '%s' must be an integer, not %s", name, getTypeName(b));
+    return static_cast<BoxedInt*>(b)->n;
+}
+
+// mmap(fileno, length[, flags[, prot]], access=ACCESS_DEFAULT, offset=0)
+//
+// Only read-only mappings are supported.  They are always MAP_SHARED, so processes that map the same
+// file share its pages in the page cache.
+Box* mmapNew(BoxedClass* cls, Box* fileno, Box* length, Box** args) {
+    assert(cls == mmap_cls);
+    Box* flags = args[0];
+    Box* prot = args[1];
+    BoxedDict* kwargs = static_cast<BoxedDict*>(args[2]);
+    assert(kwargs->cls == dict_cls);
+
+    i64 access = ACCESS_DEFAULT;
+    i64 offset = 0;
+    for (const auto& p : kwargs->d) {
+        if (p.first->cls != str_cls)
+            raiseExcHelper(TypeError, "keywords must be strings");
+        llvm::StringRef name = static_cast<BoxedString*>(p.first)->s;
+        if (name == "access")
+            access = unboxIntArg(p.second, "access");
+        else if (name == "offset")
+            offset = unboxIntArg(p.second, "offset");
+        else if (name == "flags")
+            flags = p.second;
+        else if (name == "prot")
+            prot = p.second;
+        else
+            raiseExcHelper(TypeError, "'%s' is an invalid keyword argument for this function", name.data());
+    }
+
+    int fd = unboxIntArg(fileno, "fileno");
+    i64 size = unboxIntArg(length, "length");
+    i64 map_flags = unboxIntArg(flags, "flags");
+    i64 map_prot = unboxIntArg(prot, "prot");
+
+    if (access == ACCESS_WRITE || access == ACCESS_COPY || (map_prot & PROT_WRITE))
+        raiseExcHelper(ValueError, "only read-only mmaps are supported");
+    if (access != ACCESS_DEFAULT && access != ACCESS_READ)
+        raiseExcHelper(ValueError, "mmap invalid access parameter.");
+    if (map_flags != MAP_SHARED)
+        raiseExcHelper(ValueError, "only MAP_SHARED mmaps are supported");
+    if (size < 0)
+        raiseExcHelper(ValueError, "memory mapped length must be positive");
+    if (offset < 0)
+        raiseExcHelper(ValueError, "memory mapped offset must be positive");
+    if (offset % sysconf(_SC_PAGESIZE))
+        raiseExcHelper(ValueError, "mmap offset must be a multiple of ALLOCATIONGRANULARITY");
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+        raiseExcHelper(OSError, "%s", strerror(errno));
+    if (S_ISREG(st.st_mode)) {
+        if (size == 0) {
+            if (st.st_size == 0)
+                raiseExcHelper(ValueError, "cannot mmap an empty file");
+            if (offset >= st.st_size)
+                raiseExcHelper(ValueError, "mmap offset is greater than file size");
+            size = st.st_size - offset;
+        } else if (offset > st.st_size || st.st_size - offset < size) {
+            raiseExcHelper(ValueError, "mmap length is greater than file size");
+        }
+    }
+
+    void* data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, offset);
+    if (data == MAP_FAILED)
+        raiseExcHelper(OSError, "%s", strerror(errno));
+
+    return new BoxedMmap(static_cast<const char*>(data), size);
+}
+
+static void checkOpen(BoxedMmap* self) {
+    assert(self->cls == mmap_cls);
+    if (self->closed)
+        raiseExcHelper(ValueError, "mmap closed or invalid");
+}
+
+Box* mmapClose(BoxedMmap* self) {
+    assert(self->cls == mmap_cls);
+    if (!self->closed) {
+        munmap(const_cast<char*>(self->data), self->size);
+        self->closed = true;
+        self->data = NULL;
+        self->size = self->pos = 0;
+    }
+    return None;
+}
+
+Box* mmapLen(BoxedMmap* self) {
+    checkOpen(self);
+    return boxInt(self->size);
+}
+
+Box* mmapGetitem(BoxedMmap* self, Box* slice) {
+    checkOpen(self);
+
+    if (slice->cls == int_cls) {
+        i64 n = static_cast<BoxedInt*>(slice)->n;
+        if (n < 0)
+            n += self->size;
+        if (n < 0 || n >= (i64)self->size)
+            raiseExcHelper(IndexError, "mmap index out of range");
+        return internString(llvm::StringRef(self->data + n, 1));
+    } else if (slice->cls == slice_cls) {
+        i64 start, stop, step;
+        parseSlice(static_cast<BoxedSlice*>(slice), self->size, &start, &stop, &step);
+
+        // Only the part that was asked for gets copied out of the mapping:
+        if (step == 1)
+            return boxString(llvm::StringRef(self->data + start, std::max((i64)0, stop - start)));
+
+        i64 length = 0;
+        if (step > 0 && stop > start)
+            length = (stop - start + step - 1) / step;
+        else if (step < 0 && start > stop)
+            length = (start - stop - step - 1) / (-step);
+
+        BoxedString* rtn = BoxedString::createUninitialized(length);
+        for (i64 i = 0, cur = start; i < length; i++, cur += step)
+            rtn->storage()[i] = self->data[cur];
+        return rtn;
+    } else {
+        raiseExcHelper(TypeError, "mmap indices must be integers");
+    }
+}
+
+// Turns a start/end argument of find() into a position, the same way str.find does.
+static size_t findBound(Box* b, size_t size, const char* name) {
+    i64 n = unboxIntArg(b, name);
+    if (n < 0)
+        n = std::max((i64)0, n + (i64)size);
+    return std::min((i64)size, n);
+}
+
+Box* mmapFind(BoxedMmap* self, Box* _sub, Box* _start, Box** args) {
+    checkOpen(self);
+    Box* _end = args[0];
+
+    if (_sub->cls != str_cls)
+        raiseExcHelper(TypeError, "expected a character buffer object");
+    llvm::StringRef sub = static_cast<BoxedString*>(_sub)->s;
+
+    size_t start = _start == None ? self->pos : findBound(_start, self->size, "start");
+    size_t end = _end == None ? self->size : findBound(_end, self->size, "end");
+    if (end < start)
+        return boxInt(-1);
+
+    size_t found = findSubstring(self->contents().slice(0, end), sub, start);
+    if (found == llvm::StringRef::npos)
+        return boxInt(-1);
+    return boxInt(found);
+}
+
+Box* mmapRead(BoxedMmap* self, Box* _n) {
+    checkOpen(self);
+    i64 n = unboxIntArg(_n, "n");
+
+    size_t remaining = self->size - self->pos;
+    if (n < 0 || (size_t)n > remaining)
+        n = remaining;
+
+    Box* rtn = boxString(llvm::StringRef(self->data + self->pos, n));
+    self->pos += n;
+    return rtn;
+}
+
+Box* mmapReadline(BoxedMmap* self) {
+    checkOpen(self);
+
+    const char* start = self->data + self->pos;
+    size_t remaining = self->size - self->pos;
+    const char* newline = static_cast<const char*>(memchr(start, '\n', remaining));
+    size_t n = newline ? newline - start + 1 : remaining;
+
+    Box* rtn = boxString(llvm::StringRef(start, n));
+    self->pos += n;
+    return rtn;
+}
+
+Box* mmapSeek(BoxedMmap* self, Box* _pos, Box* _whence) {
+    checkOpen(self);
+    i64 pos = unboxIntArg(_pos, "pos");
+    i64 whence = unboxIntArg(_whence, "whence");
+
+    if (whence == SEEK_CUR)
+        pos += self->pos;
+    else if (whence == SEEK_END)
+        pos += self->size;
+    else if (whence != SEEK_SET)
+        raiseExcHelper(ValueError, "unknown seek type");
+
+    if (pos < 0 || pos > (i64)self->size)
+        raiseExcHelper(ValueError, "seek out of range");
+    self->pos = pos;
+    return None;
+}
+
+Box* mmapTell(BoxedMmap* self) {
+    checkOpen(self);
+    return boxInt(self->pos);
+}
+
+void setupMmap() {
+    mmap_module = createModule("mmap", "__builtin__");
+
+    mmap_cls = new BoxedClass(object_cls, NULL, 0, sizeof(BoxedMmap), false);
+    mmap_cls->giveAttr("__name__", boxStrConstant("mmap"));
+    mmap_cls->giveAttr("__new__", new BoxedFunction(boxRTFunction((void*)mmapNew, UNKNOWN, 5, 2, false, true),
+                                                    { boxInt(MAP_SHARED), boxInt(PROT_READ) }));
+    mmap_cls->giveAttr("close", new BoxedFunction(boxRTFunction((void*)mmapClose, NONE, 1)));
+    mmap_cls->giveAttr("__len__", new BoxedFunction(boxRTFunction((void*)mmapLen, BOXED_INT, 1)));
+    mmap_cls->giveAttr("__getitem__", new BoxedFunction(boxRTFunction((void*)mmapGetitem, STR, 2)));
+    mmap_cls->giveAttr("find", new BoxedFunction(boxRTFunction((void*)mmapFind, BOXED_INT, 4, 2, false, false),
+                                                 { None, None }));
+    mmap_cls->giveAttr("read", new BoxedFunction(boxRTFunction((void*)mmapRead, STR, 2)));
+    mmap_cls->giveAttr("readline", new BoxedFunction(boxRTFunction((void*)mmapReadline, STR, 1)));
+    mmap_cls->giveAttr("seek", new BoxedFunction(boxRTFunction((void*)mmapSeek, NONE, 3, 1, false, false),
+                                                 { boxInt(SEEK_SET) }));
+    mmap_cls->giveAttr("tell", new BoxedFunction(boxRTFunction((void*)mmapTell, BOXED_INT, 1)));
+    mmap_cls->freeze();
+    mmap_module->giveAttr("mmap", mmap_cls);
+
+    mmap_module->giveAttr("error", OSError);
+    mmap_module->giveAttr("ACCESS_DEFAULT", boxInt(ACCESS_DEFAULT));
+    mmap_module->giveAttr("ACCESS_READ", boxInt(ACCESS_READ));
+    mmap_module->giveAttr("ACCESS_WRITE", boxInt(ACCESS_WRITE));
+    mmap_module->giveAttr("ACCESS_COPY", boxInt(ACCESS_COPY));
+    mmap_module->giveAttr("MAP_SHARED", boxInt(MAP_SHARED));
+    mmap_module->giveAttr("MAP_PRIVATE", boxInt(MAP_PRIVATE));
+    mmap_module->giveAttr("PROT_READ", boxInt(PROT_READ));
+    mmap_module->giveAttr("PROT_WRITE", boxInt(PROT_WRITE));
+    mmap_module->giveAttr("PAGESIZE", boxInt(sysconf(_SC_PAGESIZE)));
+    mmap_module->giveAttr("ALLOCATIONGRANULARITY", boxInt(sysconf(_SC_PAGESIZE)));
+}
+}
@@ -21,6 +21,7 @@
 #include "codegen/compvars.h"
 #include "core/threading.h"
 #include "core/types.h"
+#include "gc/collector.h"
 #include "runtime/objmodel.h"
 #include "runtime/types.h"
 
@@ -50,12 +51,51 @@ public:
 
         RELEASE_ASSERT(_key->cls == str_cls, "");
         BoxedString* key = static_cast<BoxedString*>(_key);
-        self->b->setattr(key->s, value, NULL);
+        self->b->setattr(key->s.str(), value, NULL);
 
         return None;
     }
 };
 
+// The C API's error indicator: API functions that fail set it and return an error code, since we can't
+// throw through the extension's C frames.
+static gc::StaticRootHandle cur_exc_type, cur_exc_value;
+
+extern "C" void PyErr_SetString(PyObject* type, const char* message) {
+    cur_exc_type = type;
+    cur_exc_value = boxStrConstant(message);
+}
+
+extern "C" PyObject* PyErr_Occurred() {
+    return cur_exc_type;
+}
+
+extern "C" void PyErr_Clear() {
+    cur_exc_type = NULL;
+    cur_exc_value = NULL;
+}
+
+extern "C" void PyErr_Fetch(PyObject** ptype, PyObject** pvalue, PyObject** ptraceback) {
+    *ptype = cur_exc_type;
+    *pvalue = cur_exc_value;
+    *ptraceback = NULL;
+    PyErr_Clear();
+}
+
+// Extension functions report errors by setting the error indicator and returning NULL; this turns that
+// back into a Python exception once we're out of the extension's frames.
+static Box* checkCApiResult(Box* rtn) {
+    if (rtn)
+        return rtn;
+
+    PyObject* type, *value, *tb;
+    PyErr_Fetch(&type, &value, &tb);
+    RELEASE_ASSERT(type, "C API function returned NULL without setting an error");
+    assert(isSubclass(type->cls, type_cls));
+    assert(value && value->cls == str_cls);
+    raiseExcHelper(static_cast<BoxedClass*>(type), "%s", static_cast<BoxedString*>(value)->c_str());
+}
+
 BoxedClass* method_cls;
 class BoxedMethodDescriptor : public Box {
 public:
@@ -72,6 +112,7 @@ public:
 
         threading::GLPromoteRegion _gil_lock;
 
+        PyErr_Clear();
         int ml_flags = self->method->ml_flags;
         Box* rtn;
         if (ml_flags == METH_NOARGS) {
@@ -84,8 +125,7 @@ public:
         } else {
             RELEASE_ASSERT(0, "0x%x", ml_flags);
         }
-        assert(rtn);
-        return rtn;
+        return checkCApiResult(rtn);
     }
 };
 
@@ -114,19 +154,15 @@ extern "C" PyObject* PyString_FromString(const char* s) {
 
 extern "C" PyObject* PyString_FromStringAndSize(const char* s, ssize_t n) {
     if (s == NULL)
-        return boxString(std::string(n, '\x00'));
+        return BoxedString::createUninitialized(n);
     return boxStrConstantSize(s, n);
 }
 
 extern "C" char* PyString_AsString(PyObject* o) {
     assert(o->cls == str_cls);
 
-    // TODO this is very brittle, since
-    // - you are very much not supposed to change the data, and
-    // - the pointer doesn't have great longevity guarantees
-    // To satisfy this API we might have to change the string representation?
-    printf("Warning: PyString_AsString() currently has risky behavior\n");
-    return const_cast<char*>(static_cast<BoxedString*>(o)->s.data());
+    // c_str() stays valid for as long as the string does.  You're still not supposed to change the data.
+    return const_cast<char*>(static_cast<BoxedString*>(o)->c_str());
 }
 
 extern "C" Py_ssize_t PyString_Size(PyObject* s) {
@@ -186,6 +222,7 @@ public:
 
         threading::GLPromoteRegion _gil_lock;
 
+        PyErr_Clear();
         Box* rtn;
         if (self->ml_flags == METH_VARARGS) {
             assert(kwargs->d.size() == 0);
@@ -195,8 +232,7 @@ public:
         } else {
             RELEASE_ASSERT(0, "0x%x", self->ml_flags);
         }
-        assert(rtn);
-        return rtn;
+        return checkCApiResult(rtn);
     }
 };
 
@@ -349,6 +385,40 @@ extern "C" int PyBuffer_FillInfo(Py_buffer* view, PyObject* obj, void* buf, Py_s
     return 0;
 }
 
+// Objects whose bytes can be handed out directly: strs, and mmaps (which point straight into the mapping).
+static bool getReadBuffer(PyObject* obj, const char** buffer, Py_ssize_t* len) {
+    if (obj->cls == str_cls) {
+        *buffer = PyString_AS_STRING(obj);
+        *len = PyString_GET_SIZE(obj);
+        return true;
+    }
+    if (obj->cls == mmap_cls) {
+        BoxedMmap* m = static_cast<BoxedMmap*>(obj);
+        if (m->closed)
+            return false;
+        *buffer = m->data;
+        *len = m->size;
+        return true;
+    }
+    return false;
+}
+
+extern "C" int PyObject_CheckReadBuffer(PyObject* obj) {
+    const char* buffer;
+    Py_ssize_t len;
+    return getReadBuffer(obj, &buffer, &len);
+}
+
+extern "C" int PyObject_AsReadBuffer(PyObject* obj, const void** buffer, Py_ssize_t* buffer_len) {
+    const char* buf;
+    if (!getReadBuffer(obj, &buf, buffer_len)) {
+        PyErr_SetString(TypeError, "expected a readable buffer object");
+        return -1;
+    }
+    *buffer = buf;
+    return 0;
+}
+
 extern "C" void PyBuffer_Release(Py_buffer* view) {
     if (!view->buf) {
         assert(!view->obj);
@@ -357,7 +427,7 @@ extern "C" void PyBuffer_Release(Py_buffer* view) {
 
     PyObject* obj = view->obj;
     assert(obj);
-    assert(obj->cls == str_cls);
+    assert(obj->cls == str_cls || obj->cls == mmap_cls);
     if (obj && Py_TYPE(obj)->tp_as_buffer && Py_TYPE(obj)->tp_as_buffer->bf_releasebuffer)
         Py_TYPE(obj)->tp_as_buffer->bf_releasebuffer(obj, view);
     Py_XDECREF(obj);
@@ -394,8 +464,11 @@ int vPyArg_ParseTuple(PyObject* _tuple, const char* fmt, va_list ap) {
                     if (*fmt == '*') {
                         Py_buffer* p = (Py_buffer*)va_arg(ap, Py_buffer*);
 
-                        RELEASE_ASSERT(arg->cls == str_cls, "");
-                        PyBuffer_FillInfo(p, arg, PyString_AS_STRING(arg), PyString_GET_SIZE(arg), 1, 0);
+                        const char* buffer;
+                        Py_ssize_t len;
+                        bool ok = getReadBuffer(arg, &buffer, &len);
+                        RELEASE_ASSERT(ok, "");
+                        PyBuffer_FillInfo(p, arg, const_cast<char*>(buffer), len, 1, 0);
                         fmt++;
                     } else if (*fmt == ':') {
                         break;
@@ -454,12 +527,6 @@ extern "C" void PyObject_Free(void* p) {
     ASSERT(0, "I think this is good enough but I'm not sure; should test");
 }
 
-extern "C" PyObject* PyErr_Occurred() {
-    printf("need to hook exception handling -- make sure errors dont propagate into C code, and error codes get "
-           "checked coming out\n");
-    return NULL;
-}
-
 BoxedModule* importTestExtension() {
     const char* pathname = "../test/test_extension/test.so";
     void* handle = dlopen(pathname, RTLD_NOW);
@@ -90,14 +90,35 @@ Box* dictGetitem(BoxedDict* self, Box* k) {
         BoxedString* s = reprOrNull(k);
 
         if (s)
-            raiseExcHelper(KeyError, "%s", s->s.c_str());
+            raiseExcHelper(KeyError, "%s", s->c_str());
         else
             raiseExcHelper(KeyError, "");
     }
 
-    Box* pos = self->d[k];
+    return it->second;
+}
+
+// Versions of getitem and setitem for str keys, which the getitem/setitem ICs will call
+// directly if they see a str key.  These use the string's cached hash and skip the PyHasher dispatch.
+Box* dictGetitemStr(BoxedDict* self, BoxedString* k) {
+    assert(self->cls == dict_cls);
+    assert(k->cls == str_cls);
+
+    auto it = self->d.find(k, k->hash());
+    if (it == self->d.end()) {
+        BoxedString* s = static_cast<BoxedString*>(repr(k));
+        raiseExcHelper(KeyError, "%s", s->c_str());
+    }
 
-    return pos;
+    return it->second;
+}
+
+Box* dictSetitemStr(BoxedDict* self, BoxedString* k, Box* v) {
+    assert(self->cls == dict_cls);
+    assert(k->cls == str_cls);
+
+    self->d.getOrInsert(k, k->hash()) = v;
+    return None;
 }
 
 Box* dictSetitem(BoxedDict* self, Box* k, Box* v) {
@@ -125,7 +146,7 @@ Box* dictPop(BoxedDict* self, Box* k, Box* d) {
         BoxedString* s = reprOrNull(k);
 
         if (s)
-            raiseExcHelper(KeyError, "%s", s->s.c_str());
+            raiseExcHelper(KeyError, "%s", s->c_str());
         else
             raiseExcHelper(KeyError, "");
     }
@@ -152,7 +173,7 @@ Box* dictSetdefault(BoxedDict* self, Box* k, Box* v) {
     if (it != self->d.end())
         return it->second;
 
-    self->d.insert(it, std::make_pair(k, v));
+    self->d[k] = v;
     return v;
 }
 
@@ -163,12 +184,12 @@ Box* dictContains(BoxedDict* self, Box* k) {
 
 extern "C" Box* dictNew(Box* _cls, BoxedTuple* args, BoxedDict* kwargs) {
     if (!isSubclass(_cls->cls, type_cls))
-        raiseExcHelper(TypeError, "dict.__new__(X): X is not a type object (%s)", getTypeName(_cls)->c_str());
+        raiseExcHelper(TypeError, "dict.__new__(X): X is not a type object (%s)", getTypeName(_cls));
 
     BoxedClass* cls = static_cast<BoxedClass*>(_cls);
     if (!isSubclass(cls, dict_cls))
-        raiseExcHelper(TypeError, "dict.__new__(%s): %s is not a subtype of dict", getNameOfClass(cls)->c_str(),
-                       getNameOfClass(cls)->c_str());
+        raiseExcHelper(TypeError, "dict.__new__(%s): %s is not a subtype of dict", getNameOfClass(cls),
+                       getNameOfClass(cls));
 
     RELEASE_ASSERT(cls == dict_cls, "");
 
@@ -196,7 +217,7 @@ extern "C" Box* dictNew(Box* _cls, BoxedTuple* args, BoxedDict* kwargs) {
                     raiseExcHelper(ValueError, "dictionary update sequence element #%d has length %d; 2 is required",
                                    idx, list->size);
 
-                r->d[list->elts->elts[0]] = list->elts->elts[1];
+                r->d[list->getitem(0)] = list->getitem(1);
             } else if (element->cls == tuple_cls) {
                 BoxedTuple* tuple = static_cast<BoxedTuple*>(element);
                 if (tuple->elts.size() != 2)
@@ -257,8 +278,15 @@ void setupDict() {
     dict_cls->giveAttr("setdefault",
                        new BoxedFunction(boxRTFunction((void*)dictSetdefault, UNKNOWN, 3, 1, false, false), { None }));
 
-    dict_cls->giveAttr("__getitem__", new BoxedFunction(boxRTFunction((void*)dictGetitem, UNKNOWN, 2)));
-    dict_cls->giveAttr("__setitem__", new BoxedFunction(boxRTFunction((void*)dictSetitem, NONE, 3)));
+    CLFunction* getitem = createRTFunction(2, 0, false, false);
+    addRTFunction(getitem, (void*)dictGetitemStr, UNKNOWN, std::vector<ConcreteCompilerType*>{ DICT, STR });
+    addRTFunction(getitem, (void*)dictGetitem, UNKNOWN, std::vector<ConcreteCompilerType*>{ DICT, UNKNOWN });
+    dict_cls->giveAttr("__getitem__", new BoxedFunction(getitem));
+
+    CLFunction* setitem = createRTFunction(3, 0, false, false);
+    addRTFunction(setitem, (void*)dictSetitemStr, NONE, std::vector<ConcreteCompilerType*>{ DICT, STR, UNKNOWN });
+    addRTFunction(setitem, (void*)dictSetitem, NONE, std::vector<ConcreteCompilerType*>{ DICT, UNKNOWN, UNKNOWN });
+    dict_cls->giveAttr("__setitem__", new BoxedFunction(setitem));
     dict_cls->giveAttr("__contains__", new BoxedFunction(boxRTFunction((void*)dictContains, BOXED_BOOL, 2)));
 
     dict_cls->freeze();
@@ -14,6 +14,7 @@
 
 #include <cstring>
 #include <sstream>
+#include <sys/stat.h>
 
 #include "codegen/compvars.h"
 #include "core/common.h"
@@ -30,6 +31,33 @@ Box* fileRepr(BoxedFile* self) {
     RELEASE_ASSERT(0, "");
 }
 
+// Returns how many bytes are left to read in f, or -1 if we can't tell (ex for pipes).
+static i64 bytesRemaining(FILE* f) {
+    struct stat st;
+    if (fstat(fileno(f), &st) != 0 || !S_ISREG(st.st_mode))
+        return -1;
+    long pos = ftell(f);
+    if (pos < 0)
+        return -1;
+    return std::max((i64)0, (i64)st.st_size - pos);
+}
+
+// Appends up to size bytes (or everything, if size is negative) to data.
+static void readChunks(FILE* f, i64 size, std::string& data) {
+    const i64 CHUNK_SIZE = 1 << 16;
+    while (size < 0 || (i64)data.size() < size) {
+        size_t old_size = data.size();
+        i64 to_read = size < 0 ? CHUNK_SIZE : std::min(CHUNK_SIZE, size - (i64)old_size);
+        data.resize(old_size + to_read);
+        size_t nread = fread(&data[old_size], 1, to_read, f);
+        data.resize(old_size + nread);
+        if (nread == 0) {
+            ASSERT(!ferror(f), "%d", ferror(f));
+            break;
+        }
+    }
+}
+
 Box* fileRead(BoxedFile* self, Box* _size) {
     assert(self->cls == file_cls);
     if (_size->cls != int_cls) {
@@ -43,44 +71,91 @@ Box* fileRead(BoxedFile* self, Box* _size) {
         raiseExcHelper(IOError, "");
     }
 
-    std::ostringstream os("");
+    // For regular files we know how much data is left, so we can read it straight into the result:
+    i64 remaining = bytesRemaining(self->f);
+    if (remaining >= 0 && (size < 0 || size >= remaining)) {
+        BoxedString* rtn = BoxedString::createUninitialized(remaining);
+        size_t nread = fread(rtn->storage(), 1, remaining, self->f);
+        ASSERT(!ferror(self->f), "%d", ferror(self->f));
+
+        // The file might have changed size since we looked at it, so keep going until we hit EOF or
+        // have as much as was asked for:
+        if ((i64)nread < remaining)
+            return boxString(llvm::StringRef(rtn->storage(), nread));
+        if (size == remaining || feof(self->f))
+            return rtn;
+        int c = getc(self->f);
+        if (c == EOF)
+            return rtn;
+        ungetc(c, self->f);
+
+        std::string data(rtn->s);
+        readChunks(self->f, size, data);
+        return boxString(data);
+    }
 
-    if (size < 0)
-        size = 1L << 60;
+    std::string data;
+    readChunks(self->f, size, data);
+    return boxString(data);
+}
 
-    i64 read = 0;
-    while (read < size) {
-        const int BUF_SIZE = 1024;
-        char buf[BUF_SIZE];
-        size_t more_read = fread(buf, 1, std::min((i64)BUF_SIZE, size - read), self->f);
-        if (more_read == 0) {
-            ASSERT(!ferror(self->f), "%d", ferror(self->f));
-            break;
-        }
+// The buffer that getline() reads into.  getline() needs a malloc'd buffer that it can grow, so rather
+// than tying one to each file (and leaking it if the file never gets closed), each thread reuses one.
+static __thread char* line_buf = NULL;
+static __thread size_t line_buf_size = 0;
 
-        read += more_read;
-        // this is probably inefficient:
-        os << std::string(buf, more_read);
+Box* fileReadline1(BoxedFile* self) {
+    assert(self->cls == file_cls);
+    if (self->closed)
+        raiseExcHelper(ValueError, "I/O operation on closed file");
+
+    // getline() scans the stdio buffer with memchr, and handles lines with NULs in them:
+    ssize_t n = getline(&line_buf, &line_buf_size, self->f);
+    if (n < 0) {
+        ASSERT(!ferror(self->f), "%d", ferror(self->f));
+        return boxString(llvm::StringRef());
     }
-    return boxString(os.str());
+    return boxString(llvm::StringRef(line_buf, n));
 }
 
-Box* fileReadline1(BoxedFile* self) {
+Box* fileReadlines(BoxedFile* self) {
     assert(self->cls == file_cls);
+    if (self->closed)
+        raiseExcHelper(ValueError, "I/O operation on closed file");
 
-    std::ostringstream os("");
-
+    BoxedList* rtn = new BoxedList();
     while (true) {
-        char c;
-        int nread = fread(&c, 1, 1, self->f);
-        if (nread == 0)
-            break;
-        os << c;
-
-        if (c == '\n')
+        ssize_t n = getline(&line_buf, &line_buf_size, self->f);
+        if (n < 0)
             break;
+        listAppendInternal(rtn, boxString(llvm::StringRef(line_buf, n)));
     }
-    return boxString(os.str());
+    ASSERT(!ferror(self->f), "%d", ferror(self->f));
+    return rtn;
+}
+
+Box* fileIter(BoxedFile* self) {
+    assert(self->cls == file_cls);
+    return self;
+}
+
+Box* fileHasnext(BoxedFile* self) {
+    assert(self->cls == file_cls);
+    if (self->closed)
+        raiseExcHelper(ValueError, "I/O operation on closed file");
+
+    int c = getc(self->f);
+    if (c == EOF)
+        return False;
+    ungetc(c, self->f);
+    return True;
+}
+
+Box* fileNext(BoxedFile* self) {
+    Box* line = fileReadline1(self);
+    if (static_cast<BoxedString*>(line)->s.empty())
+        raiseExcHelper(StopIteration, "");
+    return line;
 }
 
 Box* fileWrite(BoxedFile* self, Box* val) {
@@ -93,7 +168,7 @@ Box* fileWrite(BoxedFile* self, Box* val) {
 
 
     if (val->cls == str_cls) {
-        const std::string& s = static_cast<BoxedString*>(val)->s;
+        llvm::StringRef s = static_cast<BoxedString*>(val)->s;
 
         size_t size = s.size();
         size_t written = 0;
@@ -101,10 +176,10 @@ Box* fileWrite(BoxedFile* self, Box* val) {
             // const int BUF_SIZE = 1024;
             // char buf[BUF_SIZE];
             // int to_write = std::min(BUF_SIZE, size - written);
-            // memcpy(buf, s.c_str() + written, to_write);
+            // memcpy(buf, s.data() + written, to_write);
             // size_t new_written = fwrite(buf, 1, to_write, self->f);
 
-            size_t new_written = fwrite(s.c_str() + written, 1, size - written, self->f);
+            size_t new_written = fwrite(s.data() + written, 1, size - written, self->f);
 
             if (!new_written) {
                 int error = ferror(self->f);
@@ -131,10 +206,19 @@ Box* fileClose(BoxedFile* self) {
 
     fclose(self->f);
     self->closed = true;
+    free(self->io_buf);
+    self->io_buf = NULL;
 
     return None;
 }
 
+Box* fileFileno(BoxedFile* self) {
+    assert(self->cls == file_cls);
+    if (self->closed)
+        raiseExcHelper(ValueError, "I/O operation on closed file");
+    return boxInt(fileno(self->f));
+}
+
 Box* fileEnter(BoxedFile* self) {
     assert(self->cls == file_cls);
     return self;
@@ -150,9 +234,10 @@ Box* fileExit(BoxedFile* self, Box* exc_type, Box* exc_val, Box** args) {
     return fileClose(self);
 }
 
-Box* fileNew(BoxedClass* cls, Box* s, Box* m) {
+Box* fileNew(BoxedClass* cls, Box* s, Box* m, Box** args) {
     assert(cls == file_cls);
-    return open(s, m);
+    Box* buffering = args[0];
+    return open(s, m, buffering);
 }
 
 void setupFile() {
@@ -163,9 +248,15 @@ void setupFile() {
 
     CLFunction* readline = boxRTFunction((void*)fileReadline1, STR, 1);
     file_cls->giveAttr("readline", new BoxedFunction(readline));
+    file_cls->giveAttr("readlines", new BoxedFunction(boxRTFunction((void*)fileReadlines, LIST, 1)));
+
+    file_cls->giveAttr("__iter__", new BoxedFunction(boxRTFunction((void*)fileIter, typeFromClass(file_cls), 1)));
+    file_cls->giveAttr("__hasnext__", new BoxedFunction(boxRTFunction((void*)fileHasnext, BOXED_BOOL, 1)));
+    file_cls->giveAttr("next", new BoxedFunction(boxRTFunction((void*)fileNext, STR, 1)));
 
     file_cls->giveAttr("write", new BoxedFunction(boxRTFunction((void*)fileWrite, NONE, 2)));
     file_cls->giveAttr("close", new BoxedFunction(boxRTFunction((void*)fileClose, NONE, 1)));
+    file_cls->giveAttr("fileno", new BoxedFunction(boxRTFunction((void*)fileFileno, BOXED_INT, 1)));
 
     file_cls->giveAttr("__repr__", new BoxedFunction(boxRTFunction((void*)fileRepr, STR, 1)));
     file_cls->giveAttr("__str__", file_cls->getattr("__repr__"));
@@ -173,8 +264,8 @@ void setupFile() {
     file_cls->giveAttr("__enter__", new BoxedFunction(boxRTFunction((void*)fileEnter, typeFromClass(file_cls), 1)));
     file_cls->giveAttr("__exit__", new BoxedFunction(boxRTFunction((void*)fileExit, UNKNOWN, 4)));
 
-    file_cls->giveAttr("__new__", new BoxedFunction(boxRTFunction((void*)fileNew, UNKNOWN, 3, 1, false, false),
-                                                    { boxStrConstant("r") }));
+    file_cls->giveAttr("__new__", new BoxedFunction(boxRTFunction((void*)fileNew, UNKNOWN, 4, 2, false, false),
+                                                    { boxStrConstant("r"), boxInt(-1) }));
 
     file_cls->freeze();
 }
@@ -507,7 +507,7 @@ Box* floatNew(BoxedClass* cls, Box* a) {
     if (a->cls == float_cls) {
         return a;
     } else if (a->cls == str_cls) {
-        const std::string& s = static_cast<BoxedString*>(a)->s;
+        llvm::StringRef s = static_cast<BoxedString*>(a)->s;
         if (s == "nan")
             return boxFloat(NAN);
         if (s == "-nan")
@@ -517,9 +517,9 @@ Box* floatNew(BoxedClass* cls, Box* a) {
         if (s == "-inf")
             return boxFloat(-INFINITY);
 
-        return boxFloat(strtod(s.c_str(), NULL));
+        return boxFloat(strtod(static_cast<BoxedString*>(a)->c_str(), NULL));
     }
-    RELEASE_ASSERT(0, "%s", getTypeName(a)->c_str());
+    RELEASE_ASSERT(0, "%s", getTypeName(a));
 }
 
 Box* floatStr(BoxedFloat* self) {
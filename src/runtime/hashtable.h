@@ -0,0 +1,362 @@
+// Copyright (c) 2014 Dropbox, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PYSTON_RUNTIME_HASHTABLE_H
+#define PYSTON_RUNTIME_HASHTABLE_H
+
+#include <cstdint>
+#include <cstring>
+
+#include "core/common.h"
+#include "core/types.h"
+#include "gc/gc_alloc.h"
+
+namespace pyston {
+
+// The hash tables that back dicts and sets.
+//
+// This follows the layout of CPython's "compact dict": the entries live in a dense array,
+// in insertion order, and each one caches the hash of its key.  A separate, sparse index
+// array maps hash buckets to positions in the entry array and is probed with open addressing.
+// Compared to std::unordered_map this means no allocation per entry, no rehashing of keys when
+// the table grows, and cheap iteration.
+//
+// Deleted entries leave a hole (first == NULL) in the entry array and a DUMMY in the index
+// array; both get cleaned up the next time the table is resized.
+//
+// Entry has to provide "hash" and "first" fields; the key is "first" so that dict entries
+// look like the std::pair's that the rest of the runtime is used to.
+//
+// Eq has to provide isSimpleKey() and simpleEq(): as long as every key that has been put in the
+// table is simple (ie a str), lookups of simple keys compare them with simpleEq directly, and
+// don't have to worry about the comparison running code that mutates the table.
+//
+// The arrays are allocated from the GC heap: the entry array conservatively, so that the keys
+// and values get scanned through it, and the index array as untracked memory.
+// The owner's GC handler needs to visit the table object itself.
+template <typename Entry, typename Hash, typename Eq> class PyHashTable {
+private:
+    static const int32_t EMPTY = -1;
+    static const int32_t DUMMY = -2;
+    static const int MIN_INDEX_SIZE = 8;
+
+    int32_t* indices;
+    Entry* entries;
+    int index_mask;       // number of index slots, minus one
+    int entries_capacity; // how many entries fit before we have to resize
+    int num_entries;      // entries in use, including holes left by deletions
+    int num_live;
+    bool only_simple_keys;
+
+    static int usableFor(int index_size) { return (index_size * 2) / 3; }
+
+    int findSlot(size_t hash) const {
+        size_t perturb = hash;
+        size_t i = hash & index_mask;
+        while (indices[i] >= 0)
+            i = nextProbe(i, perturb);
+        return i;
+    }
+
+    size_t nextProbe(size_t i, size_t& perturb) const {
+        perturb >>= 5;
+        return (i * 5 + perturb + 1) & index_mask;
+    }
+
+    void allocate(int index_size) {
+        assert((index_size & (index_size - 1)) == 0);
+        indices = (int32_t*)gc::gc_alloc(index_size * sizeof(int32_t), gc::GCKind::UNTRACKED);
+        memset(indices, 0xff, index_size * sizeof(int32_t)); // all EMPTY
+        index_mask = index_size - 1;
+        entries_capacity = usableFor(index_size);
+        entries = (Entry*)gc::gc_alloc(entries_capacity * sizeof(Entry), gc::GCKind::CONSERVATIVE);
+        num_entries = 0;
+    }
+
+    // Resize so that there is room for at least min_live entries, dropping any holes.
+    void resize(int min_live) {
+        int index_size = MIN_INDEX_SIZE;
+        while (usableFor(index_size) <= min_live)
+            index_size *= 2;
+
+        int32_t* old_indices = indices;
+        Entry* old_entries = entries;
+        int old_num_entries = num_entries;
+
+        allocate(index_size);
+        for (int i = 0; i < old_num_entries; i++) {
+            if (old_entries[i].first == NULL)
+                continue;
+            indices[findSlot(old_entries[i].hash)] = num_entries;
+            entries[num_entries++] = old_entries[i];
+        }
+        assert(num_entries == num_live);
+
+        if (old_indices) {
+            gc::gc_free(old_indices);
+            gc::gc_free(old_entries);
+        }
+    }
+
+    // Same as lookup(), for when the table and the key are all simple.
+    int lookupSimple(Box* key, size_t hash, int* insert_slot) const {
+        if (!indices)
+            return -1;
+
+        size_t perturb = hash;
+        size_t i = hash & index_mask;
+        int first_dummy = -1;
+        while (true) {
+            int32_t ix = indices[i];
+            if (ix == EMPTY) {
+                if (insert_slot)
+                    *insert_slot = (first_dummy == -1) ? i : first_dummy;
+                return -1;
+            }
+
+            if (ix == DUMMY) {
+                if (first_dummy == -1)
+                    first_dummy = i;
+            } else {
+                const Entry& e = entries[ix];
+                if (e.first == key || (e.hash == hash && Eq::simpleEq(e.first, key)))
+                    return ix;
+            }
+            i = nextProbe(i, perturb);
+        }
+    }
+
+    // Returns the position of the key in the entry array, or -1 if it isn't in the table.
+    // If it isn't, and insert_slot is non-NULL, sets it to the index slot to use for inserting the key.
+    int lookup(Box* key, size_t hash, int* insert_slot) const {
+        if (only_simple_keys && Eq::isSimpleKey(key))
+            return lookupSimple(key, hash, insert_slot);
+
+    restart:
+        if (!indices)
+            return -1;
+
+        size_t perturb = hash;
+        size_t i = hash & index_mask;
+        int first_dummy = -1;
+        while (true) {
+            int32_t ix = indices[i];
+            if (ix == EMPTY) {
+                if (insert_slot)
+                    *insert_slot = (first_dummy == -1) ? i : first_dummy;
+                return -1;
+            }
+
+            if (ix == DUMMY) {
+                if (first_dummy == -1)
+                    first_dummy = i;
+            } else {
+                const Entry& e = entries[ix];
+                if (e.first == key)
+                    return ix;
+                if (e.hash == hash) {
+                    Box* startkey = e.first;
+                    Entry* start_entries = entries;
+                    bool eq = Eq()(startkey, key);
+
+                    // The comparison could have run arbitrary code that mutated the table; start over if so:
+                    if (entries != start_entries || entries[ix].first != startkey)
+                        goto restart;
+                    if (eq)
+                        return ix;
+                }
+            }
+            i = nextProbe(i, perturb);
+        }
+    }
+
+    int indexSlotOf(int entry_idx) const {
+        size_t perturb = entries[entry_idx].hash;
+        size_t i = perturb & index_mask;
+        while (indices[i] != entry_idx) {
+            assert(indices[i] != EMPTY);
+            i = nextProbe(i, perturb);
+        }
+        return i;
+    }
+
+    // Adds a new entry for a key that isn't in the table, and returns it.
+    Entry& insertNew(Box* key, size_t hash, int slot) {
+        if (num_entries == entries_capacity) {
+            resize(num_live + 1);
+            slot = findSlot(hash);
+        }
+
+        assert(indices[slot] < 0);
+        indices[slot] = num_entries;
+        Entry& e = entries[num_entries++];
+        memset(&e, 0, sizeof(Entry));
+        e.hash = hash;
+        e.first = key;
+        num_live++;
+        if (only_simple_keys && !Eq::isSimpleKey(key))
+            only_simple_keys = false;
+        return e;
+    }
+
+protected:
+    // Returns the entry for the key, adding a zero-initialized one if there isn't one already.
+    Entry& getOrInsert(Box* key, size_t hash) {
+        int slot = -1;
+        int idx = lookup(key, hash, &slot);
+        if (idx != -1)
+            return entries[idx];
+
+        if (!indices) {
+            resize(1);
+            slot = findSlot(hash);
+        }
+        return insertNew(key, hash, slot);
+    }
+
+    Entry* entryAt(int idx) const { return &entries[idx]; }
+
+public:
+    // Iterates over the live entries, in insertion order.  Iterators are positions in the entry
+    // array, so they stay valid across insertions that don't cause a resize.
+    template <typename Derived> class iterator_base {
+    protected:
+        const PyHashTable* table;
+        int idx;
+
+        void skipHoles() {
+            while (idx < table->num_entries && table->entries[idx].first == NULL)
+                idx++;
+        }
+
+    public:
+        iterator_base(const PyHashTable* table, int idx) : table(table), idx(idx) { skipHoles(); }
+
+        bool operator==(const Derived& rhs) const { return idx == rhs.idx; }
+        bool operator!=(const Derived& rhs) const { return idx != rhs.idx; }
+        Derived& operator++() {
+            idx++;
+            skipHoles();
+            return *static_cast<Derived*>(this);
+        }
+
+        friend class PyHashTable;
+    };
+
+    PyHashTable()
+        : indices(NULL), entries(NULL), index_mask(0), entries_capacity(0), num_entries(0), num_live(0),
+          only_simple_keys(true) {}
+    PyHashTable(const PyHashTable&) = delete;
+    PyHashTable& operator=(const PyHashTable&) = delete;
+
+    size_t size() const { return num_live; }
+    bool empty() const { return num_live == 0; }
+
+    size_t count(Box* key) const {
+        size_t hash = Hash()(key);
+        return lookup(key, hash, NULL) != -1;
+    }
+
+    void clear() {
+        if (indices) {
+            gc::gc_free(indices);
+            gc::gc_free(entries);
+        }
+        indices = NULL;
+        entries = NULL;
+        index_mask = entries_capacity = num_entries = num_live = 0;
+        only_simple_keys = true;
+    }
+
+protected:
+    int findIdx(Box* key, size_t hash) const {
+        int idx = lookup(key, hash, NULL);
+        return idx == -1 ? num_entries : idx;
+    }
+
+    int endIdx() const { return num_entries; }
+
+    void eraseIdx(int idx) {
+        assert(idx >= 0 && idx < num_entries);
+        assert(entries[idx].first != NULL);
+
+        indices[indexSlotOf(idx)] = DUMMY;
+        memset(&entries[idx], 0, sizeof(Entry));
+        num_live--;
+    }
+};
+
+struct DictEntry {
+    size_t hash;
+    Box* first;
+    Box* second;
+};
+
+template <typename Hash, typename Eq> class PyHashMap : public PyHashTable<DictEntry, Hash, Eq> {
+private:
+    typedef PyHashTable<DictEntry, Hash, Eq> Base;
+
+public:
+    class iterator : public Base::template iterator_base<iterator> {
+    public:
+        iterator(const Base* table, int idx) : Base::template iterator_base<iterator>(table, idx) {}
+
+        DictEntry& operator*() const { return *static_cast<const PyHashMap*>(this->table)->entryAt(this->idx); }
+        DictEntry* operator->() const { return static_cast<const PyHashMap*>(this->table)->entryAt(this->idx); }
+
+        friend class PyHashMap;
+    };
+
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, this->endIdx()); }
+    iterator find(Box* key) const { return iterator(this, this->findIdx(key, Hash()(key))); }
+    Box*& operator[](Box* key) { return getOrInsert(key, Hash()(key)); }
+
+    // Versions that take the hash of the key, for callers that already know it:
+    iterator find(Box* key, size_t hash) const { return iterator(this, this->findIdx(key, hash)); }
+    Box*& getOrInsert(Box* key, size_t hash) { return Base::getOrInsert(key, hash).second; }
+
+    void erase(iterator it) { this->eraseIdx(it.idx); }
+};
+
+struct SetEntry {
+    size_t hash;
+    Box* first;
+};
+
+template <typename Hash, typename Eq> class PyHashSet : public PyHashTable<SetEntry, Hash, Eq> {
+private:
+    typedef PyHashTable<SetEntry, Hash, Eq> Base;
+
+public:
+    class iterator : public Base::template iterator_base<iterator> {
+    public:
+        iterator(const Base* table, int idx) : Base::template iterator_base<iterator>(table, idx) {}
+
+        Box* operator*() const { return static_cast<const PyHashSet*>(this->table)->entryAt(this->idx)->first; }
+
+        friend class PyHashSet;
+    };
+
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, this->endIdx()); }
+    iterator find(Box* key) const { return iterator(this, this->findIdx(key, Hash()(key))); }
+
+    void insert(Box* key) { this->getOrInsert(key, Hash()(key)); }
+
+    void erase(iterator it) { this->eraseIdx(it.idx); }
+};
+}
+
+#endif
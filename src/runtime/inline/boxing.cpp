@@ -29,32 +29,30 @@ extern "C" Box* createList() {
 }
 
 extern "C" BoxedString* boxStrConstant(const char* chars) {
-    return new BoxedString(chars);
+    return internIfNameLike(chars);
 }
 
 extern "C" BoxedString* boxStrConstantSize(const char* chars, size_t n) {
-    return new BoxedString(chars, n);
+    return new (n) BoxedString(chars, n);
 }
 
+// Used for the string literals in jitted code.
 extern "C" Box* boxStringPtr(const std::string* s) {
-    return new BoxedString(*s);
+    return internIfNameLike(*s);
 }
 
-Box* boxString(const std::string& s) {
-    return new BoxedString(s);
-}
-Box* boxString(std::string&& s) {
-    return new BoxedString(std::move(s));
+BoxedString* boxString(llvm::StringRef s) {
+    return new (s.size()) BoxedString(s.data(), s.size());
 }
 
 extern "C" double unboxFloat(Box* b) {
-    ASSERT(b->cls == float_cls, "%s", getTypeName(b)->c_str());
+    ASSERT(b->cls == float_cls, "%s", getTypeName(b));
     BoxedFloat* f = (BoxedFloat*)b;
     return f->d;
 }
 
 i64 unboxInt(Box* b) {
-    ASSERT(b->cls == int_cls, "%s", getTypeName(b)->c_str());
+    ASSERT(b->cls == int_cls, "%s", getTypeName(b));
     return ((BoxedInt*)b)->n;
 }
 
@@ -56,11 +56,61 @@ Box* listiterNext(Box* s) {
         raiseExcHelper(StopIteration, "");
     }
 
-    Box* rtn = self->l->elts->elts[self->pos];
+    Box* rtn = self->l->getitem(self->pos);
     self->pos++;
     return rtn;
 }
 
+static BoxedList::Strategy strategyFor(Box* v) {
+    if (v->cls == int_cls)
+        return BoxedList::INT;
+    if (v->cls == float_cls)
+        return BoxedList::FLOAT;
+    return BoxedList::OBJECT;
+}
+
+Box* BoxedList::getitem(int64_t i) {
+    assert(0 <= i && i < size);
+    switch (strategy) {
+        case INT:
+            return boxInt(elts->ints()[i]);
+        case FLOAT:
+            return boxFloat(elts->floats()[i]);
+        default:
+            return elts->elts[i];
+    }
+}
+
+void BoxedList::prepareToStore(Box* v) {
+    if (strategy == OBJECT && size > 0)
+        return;
+
+    Strategy needed = strategyFor(v);
+    if (needed == strategy)
+        return;
+
+    if (size == 0)
+        strategy = needed;
+    else
+        convertToObjects();
+}
+
+void BoxedList::setitem(int64_t i, Box* v) {
+    assert(0 <= i && i < capacity);
+    prepareToStore(v);
+    switch (strategy) {
+        case INT:
+            elts->ints()[i] = static_cast<BoxedInt*>(v)->n;
+            break;
+        case FLOAT:
+            elts->floats()[i] = static_cast<BoxedFloat*>(v)->d;
+            break;
+        default:
+            elts->elts[i] = v;
+            break;
+    }
+}
+
 const int BoxedList::INITIAL_CAPACITY = 8;
 // TODO the inliner doesn't want to inline these; is there any point to having them in the inline section?
 void BoxedList::shrink() {
@@ -105,7 +155,7 @@ extern "C" void listAppendInternal(Box* s, Box* v) {
     self->ensure(1);
 
     assert(self->size < self->capacity);
-    self->elts->elts[self->size] = v;
+    self->setitem(self->size, v);
     self->size++;
 }
 
@@ -120,9 +170,15 @@ extern "C" void listAppendArrayInternal(Box* s, Box** v, int nelts) {
     self->ensure(nelts);
 
     assert(self->size <= self->capacity);
-    memcpy(&self->elts->elts[self->size], &v[0], nelts * sizeof(Box*));
-
-    self->size += nelts;
+    if (self->strategy == BoxedList::OBJECT && self->size > 0) {
+        memcpy(&self->elts->elts[self->size], &v[0], nelts * sizeof(Box*));
+        self->size += nelts;
+    } else {
+        for (int i = 0; i < nelts; i++) {
+            self->setitem(self->size, v[i]);
+            self->size++;
+        }
+    }
 }
 
 // TODO the inliner doesn't want to inline these; is there any point to having them in the inline section?
@@ -128,7 +128,12 @@ extern "C" Box* pow_i64_i64(i64 lhs, i64 rhs) {
     // TODO overflow very possible
     i64 orig_rhs = rhs;
     i64 rtn = 1, curpow = lhs;
-    RELEASE_ASSERT(rhs >= 0, "");
+
+    if (rhs < 0) {
+        if (lhs == 0)
+            raiseExcHelper(ZeroDivisionError, "0.0 cannot be raised to a negative power");
+        return boxFloat(pow(lhs, rhs));
+    }
 
     while (rhs) {
         if (rhs & 1) {
@@ -191,7 +196,7 @@ extern "C" Box* intAddFloat(BoxedInt* lhs, BoxedFloat* rhs) {
 extern "C" Box* intAdd(BoxedInt* lhs, Box* rhs) {
     if (!isSubclass(lhs->cls, int_cls))
         raiseExcHelper(TypeError, "descriptor '__add__' requires a 'int' object but received a '%s'",
-                       getTypeName(rhs)->c_str());
+                       getTypeName(rhs));
 
     if (isSubclass(rhs->cls, int_cls)) {
         BoxedInt* rhs_int = static_cast<BoxedInt*>(rhs);
@@ -199,6 +204,8 @@ extern "C" Box* intAdd(BoxedInt* lhs, Box* rhs) {
     } else if (rhs->cls == float_cls) {
         BoxedFloat* rhs_float = static_cast<BoxedFloat*>(rhs);
         return boxFloat(lhs->n + rhs_float->d);
+    } else if (rhs->cls == long_cls) {
+        return longAdd(static_cast<BoxedLong*>(rhs), lhs);
     } else {
         return NotImplemented;
     }
@@ -311,11 +318,17 @@ extern "C" Box* intEqInt(BoxedInt* lhs, BoxedInt* rhs) {
 
 extern "C" Box* intEq(BoxedInt* lhs, Box* rhs) {
     assert(lhs->cls == int_cls);
-    if (rhs->cls != int_cls) {
+    if (rhs->cls == int_cls) {
+        BoxedInt* rhs_int = static_cast<BoxedInt*>(rhs);
+        return boxBool(lhs->n == rhs_int->n);
+    } else if (rhs->cls == float_cls) {
+        BoxedFloat* rhs_float = static_cast<BoxedFloat*>(rhs);
+        return boxBool(lhs->n == rhs_float->d);
+    } else if (rhs->cls == long_cls) {
+        return longEq(static_cast<BoxedLong*>(rhs), lhs);
+    } else {
         return NotImplemented;
     }
-    BoxedInt* rhs_int = static_cast<BoxedInt*>(rhs);
-    return boxBool(lhs->n == rhs_int->n);
 }
 
 extern "C" Box* intNeInt(BoxedInt* lhs, BoxedInt* rhs) {
@@ -326,11 +339,17 @@ extern "C" Box* intNeInt(BoxedInt* lhs, BoxedInt* rhs) {
 
 extern "C" Box* intNe(BoxedInt* lhs, Box* rhs) {
     assert(lhs->cls == int_cls);
-    if (rhs->cls != int_cls) {
+    if (rhs->cls == int_cls) {
+        BoxedInt* rhs_int = static_cast<BoxedInt*>(rhs);
+        return boxBool(lhs->n != rhs_int->n);
+    } else if (rhs->cls == float_cls) {
+        BoxedFloat* rhs_float = static_cast<BoxedFloat*>(rhs);
+        return boxBool(lhs->n != rhs_float->d);
+    } else if (rhs->cls == long_cls) {
+        return longNe(static_cast<BoxedLong*>(rhs), lhs);
+    } else {
         return NotImplemented;
     }
-    BoxedInt* rhs_int = static_cast<BoxedInt*>(rhs);
-    return boxBool(lhs->n != rhs_int->n);
 }
 
 extern "C" Box* intLtInt(BoxedInt* lhs, BoxedInt* rhs) {
@@ -341,11 +360,17 @@ extern "C" Box* intLtInt(BoxedInt* lhs, BoxedInt* rhs) {
 
 extern "C" Box* intLt(BoxedInt* lhs, Box* rhs) {
     assert(lhs->cls == int_cls);
-    if (rhs->cls != int_cls) {
+    if (rhs->cls == int_cls) {
+        BoxedInt* rhs_int = static_cast<BoxedInt*>(rhs);
+        return boxBool(lhs->n < rhs_int->n);
+    } else if (rhs->cls == float_cls) {
+        BoxedFloat* rhs_float = static_cast<BoxedFloat*>(rhs);
+        return boxBool(lhs->n < rhs_float->d);
+    } else if (rhs->cls == long_cls) {
+        return longGt(static_cast<BoxedLong*>(rhs), lhs);
+    } else {
         return NotImplemented;
     }
-    BoxedInt* rhs_int = static_cast<BoxedInt*>(rhs);
-    return boxBool(lhs->n < rhs_int->n);
 }
 
 extern "C" Box* intLeInt(BoxedInt* lhs, BoxedInt* rhs) {
@@ -356,11 +381,17 @@ extern "C" Box* intLeInt(BoxedInt* lhs, BoxedInt* rhs) {
 
 extern "C" Box* intLe(BoxedInt* lhs, Box* rhs) {
     assert(lhs->cls == int_cls);
-    if (rhs->cls != int_cls) {
+    if (rhs->cls == int_cls) {
+        BoxedInt* rhs_int = static_cast<BoxedInt*>(rhs);
+        return boxBool(lhs->n <= rhs_int->n);
+    } else if (rhs->cls == float_cls) {
+        BoxedFloat* rhs_float = static_cast<BoxedFloat*>(rhs);
+        return boxBool(lhs->n <= rhs_float->d);
+    } else if (rhs->cls == long_cls) {
+        return longGe(static_cast<BoxedLong*>(rhs), lhs);
+    } else {
         return NotImplemented;
     }
-    BoxedInt* rhs_int = static_cast<BoxedInt*>(rhs);
-    return boxBool(lhs->n <= rhs_int->n);
 }
 
 extern "C" Box* intGtInt(BoxedInt* lhs, BoxedInt* rhs) {
@@ -371,11 +402,17 @@ extern "C" Box* intGtInt(BoxedInt* lhs, BoxedInt* rhs) {
 
 extern "C" Box* intGt(BoxedInt* lhs, Box* rhs) {
     assert(lhs->cls == int_cls);
-    if (rhs->cls != int_cls) {
+    if (rhs->cls == int_cls) {
+        BoxedInt* rhs_int = static_cast<BoxedInt*>(rhs);
+        return boxBool(lhs->n > rhs_int->n);
+    } else if (rhs->cls == float_cls) {
+        BoxedFloat* rhs_float = static_cast<BoxedFloat*>(rhs);
+        return boxBool(lhs->n > rhs_float->d);
+    } else if (rhs->cls == long_cls) {
+        return longLt(static_cast<BoxedLong*>(rhs), lhs);
+    } else {
         return NotImplemented;
     }
-    BoxedInt* rhs_int = static_cast<BoxedInt*>(rhs);
-    return boxBool(lhs->n > rhs_int->n);
 }
 
 extern "C" Box* intGeInt(BoxedInt* lhs, BoxedInt* rhs) {
@@ -386,11 +423,17 @@ extern "C" Box* intGeInt(BoxedInt* lhs, BoxedInt* rhs) {
 
 extern "C" Box* intGe(BoxedInt* lhs, Box* rhs) {
     assert(lhs->cls == int_cls);
-    if (rhs->cls != int_cls) {
+    if (rhs->cls == int_cls) {
+        BoxedInt* rhs_int = static_cast<BoxedInt*>(rhs);
+        return boxBool(lhs->n >= rhs_int->n);
+    } else if (rhs->cls == float_cls) {
+        BoxedFloat* rhs_float = static_cast<BoxedFloat*>(rhs);
+        return boxBool(lhs->n >= rhs_float->d);
+    } else if (rhs->cls == long_cls) {
+        return longLe(static_cast<BoxedLong*>(rhs), lhs);
+    } else {
         return NotImplemented;
     }
-    BoxedInt* rhs_int = static_cast<BoxedInt*>(rhs);
-    return boxBool(lhs->n >= rhs_int->n);
 }
 
 extern "C" Box* intLShiftInt(BoxedInt* lhs, BoxedInt* rhs) {
@@ -463,6 +506,8 @@ extern "C" Box* intMul(BoxedInt* lhs, Box* rhs) {
     } else if (rhs->cls == float_cls) {
         BoxedFloat* rhs_float = static_cast<BoxedFloat*>(rhs);
         return intMulFloat(lhs, rhs_float);
+    } else if (rhs->cls == long_cls) {
+        return longMul(static_cast<BoxedLong*>(rhs), lhs);
     } else {
         return NotImplemented;
     }
@@ -529,6 +574,8 @@ extern "C" Box* intSub(BoxedInt* lhs, Box* rhs) {
     } else if (rhs->cls == float_cls) {
         BoxedFloat* rhs_float = static_cast<BoxedFloat*>(rhs);
         return intSubFloat(lhs, rhs_float);
+    } else if (rhs->cls == long_cls) {
+        return longRSub(static_cast<BoxedLong*>(rhs), lhs);
     } else {
         return NotImplemented;
     }
@@ -542,7 +589,7 @@ extern "C" Box* intInvert(BoxedInt* v) {
 extern "C" Box* intPos(BoxedInt* v) {
     if (!isSubclass(v->cls, int_cls))
         raiseExcHelper(TypeError, "descriptor '__pos__' requires a 'int' object but received a '%s'",
-                       getTypeName(v)->c_str());
+                       getTypeName(v));
 
     if (v->cls == int_cls)
         return v;
@@ -572,11 +619,11 @@ extern "C" Box* intNonzero(BoxedInt* v) {
 extern "C" BoxedString* intRepr(BoxedInt* v) {
     if (!isSubclass(v->cls, int_cls))
         raiseExcHelper(TypeError, "descriptor '__repr__' requires a 'int' object but received a '%s'",
-                       getTypeName(v)->c_str());
+                       getTypeName(v));
 
     char buf[80];
     int len = snprintf(buf, 80, "%ld", v->n);
-    return new BoxedString(std::string(buf, len));
+    return boxString(llvm::StringRef(buf, len));
 }
 
 extern "C" Box* intHash(BoxedInt* self) {
@@ -586,12 +633,12 @@ extern "C" Box* intHash(BoxedInt* self) {
 
 extern "C" Box* intNew(Box* _cls, Box* val) {
     if (!isSubclass(_cls->cls, type_cls))
-        raiseExcHelper(TypeError, "int.__new__(X): X is not a type object (%s)", getTypeName(_cls)->c_str());
+        raiseExcHelper(TypeError, "int.__new__(X): X is not a type object (%s)", getTypeName(_cls));
 
     BoxedClass* cls = static_cast<BoxedClass*>(_cls);
     if (!isSubclass(cls, int_cls))
-        raiseExcHelper(TypeError, "int.__new__(%s): %s is not a subtype of int", getNameOfClass(cls)->c_str(),
-                       getNameOfClass(cls)->c_str());
+        raiseExcHelper(TypeError, "int.__new__(%s): %s is not a subtype of int", getNameOfClass(cls),
+                       getNameOfClass(cls));
 
     assert(cls->tp_basicsize >= sizeof(BoxedInt));
     void* mem = gc_alloc(cls->tp_basicsize, gc::GCKind::PYTHON);
@@ -603,7 +650,7 @@ extern "C" Box* intNew(Box* _cls, Box* val) {
     } else if (val->cls == str_cls) {
         BoxedString* s = static_cast<BoxedString*>(val);
 
-        std::istringstream ss(s->s);
+        std::istringstream ss(s->s.str());
         int64_t n;
         ss >> n;
         rtn->n = n;
@@ -613,7 +660,7 @@ extern "C" Box* intNew(Box* _cls, Box* val) {
         rtn->n = d;
     } else {
         fprintf(stderr, "TypeError: int() argument must be a string or a number, not '%s'\n",
-                getTypeName(val)->c_str());
+                getTypeName(val));
         raiseExcHelper(TypeError, "");
     }
     return rtn;
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <functional>
 #include <sstream>
 
 #include "codegen/compvars.h"
@@ -25,11 +26,70 @@
 #include "core/types.h"
 #include "gc/collector.h"
 #include "runtime/objmodel.h"
+#include "runtime/timsort.h"
 #include "runtime/types.h"
 #include "runtime/util.h"
 
 namespace pyston {
 
+void BoxedList::convertToObjects() {
+    if (strategy == OBJECT)
+        return;
+    if (size == 0) {
+        strategy = OBJECT;
+        return;
+    }
+
+    static StatCounter sc("list_strategy_conversions");
+    sc.log();
+
+    // Boxing the elements can trigger a collection, so the new array gets filled in while it's
+    // already attached to the list; the old one is kept alive by the stack.
+    GCdArray* old_elts = elts;
+    Strategy old_strategy = strategy;
+    int64_t n = size;
+
+    elts = new (capacity) GCdArray();
+    strategy = OBJECT;
+    size = 0;
+    for (int64_t i = 0; i < n; i++) {
+        if (old_strategy == INT)
+            elts->elts[i] = boxInt(old_elts->ints()[i]);
+        else
+            elts->elts[i] = boxFloat(old_elts->floats()[i]);
+        size++;
+    }
+
+    delete old_elts;
+}
+
+// Appends other[start:start+n] to self, copying the raw elements if both lists use the same storage.
+static void appendFromList(BoxedList* self, BoxedList* other, int64_t start, int64_t n) {
+    if (n == 0)
+        return;
+
+    self->ensure(n);
+    if (self->size == 0)
+        self->strategy = other->strategy;
+    else if (self->strategy != other->strategy)
+        self->convertToObjects();
+
+    if (self->strategy == other->strategy) {
+        memcpy(self->elts->elts + self->size, other->elts->elts + start, n * sizeof(Box*));
+        self->size += n;
+    } else {
+        for (int64_t i = 0; i < n; i++) {
+            self->elts->elts[self->size] = other->getitem(start + i);
+            self->size++;
+        }
+    }
+}
+
+template <typename T> static void copyStrided(T* dest, T* src, i64 start, i64 step, i64 n) {
+    for (i64 i = 0; i < n; i++)
+        dest[i] = src[start + i * step];
+}
+
 extern "C" Box* listRepr(BoxedList* self) {
     LOCK_REGION(self->lock.asRead());
 
@@ -40,11 +100,11 @@ extern "C" Box* listRepr(BoxedList* self) {
         if (i > 0)
             os << ", ";
 
-        BoxedString* s = static_cast<BoxedString*>(repr(self->elts->elts[i]));
-        os << s->s;
+        BoxedString* s = static_cast<BoxedString*>(repr(self->getitem(i)));
+        os << s->s.str();
     }
     os << ']';
-    return new BoxedString(os.str());
+    return boxString(os.str());
 }
 
 extern "C" Box* listNonzero(BoxedList* self) {
@@ -59,8 +119,8 @@ extern "C" Box* listPop(BoxedList* self, Box* idx) {
             raiseExcHelper(IndexError, "pop from empty list");
         }
 
+        Box* rtn = self->getitem(self->size - 1);
         self->size--;
-        Box* rtn = self->elts->elts[self->size];
         return rtn;
     }
 
@@ -80,7 +140,7 @@ extern "C" Box* listPop(BoxedList* self, Box* idx) {
         raiseExcHelper(IndexError, "");
     }
 
-    Box* rtn = self->elts->elts[n];
+    Box* rtn = self->getitem(n);
     memmove(self->elts->elts + n, self->elts->elts + n + 1, (self->size - n - 1) * sizeof(Box*));
     self->size--;
 
@@ -104,16 +164,30 @@ Box* _listSlice(BoxedList* self, i64 start, i64 stop, i64 step) {
 
     BoxedList* rtn = new BoxedList();
 
-    if ((step == 1) && ((stop - start) > 0)) {
-        listAppendArrayInternal(rtn, &self->elts->elts[start], stop - start);
-    } else {
-        int cur = start;
-        while ((step > 0 && cur < stop) || (step < 0 && cur > stop)) {
-            listAppendInternal(rtn, self->elts->elts[cur]);
-            cur += step;
-        }
+    if (step == 1) {
+        if (stop > start)
+            appendFromList(rtn, self, start, stop - start);
+        return rtn;
     }
 
+    i64 n = 0;
+    if (step > 0 && stop > start)
+        n = (stop - start + step - 1) / step;
+    else if (step < 0 && start > stop)
+        n = (start - stop - step - 1) / (-step);
+    if (n == 0)
+        return rtn;
+
+    rtn->ensure(n);
+    rtn->strategy = self->strategy;
+    if (self->strategy == BoxedList::INT)
+        copyStrided(rtn->elts->ints(), self->elts->ints(), start, step, n);
+    else if (self->strategy == BoxedList::FLOAT)
+        copyStrided(rtn->elts->floats(), self->elts->floats(), start, step, n);
+    else
+        copyStrided(rtn->elts->elts, self->elts->elts, start, step, n);
+    rtn->size = n;
+
     return rtn;
 }
 
@@ -129,7 +203,7 @@ extern "C" Box* listGetitemInt(BoxedList* self, BoxedInt* slice) {
     if (n < 0 || n >= self->size) {
         raiseExcHelper(IndexError, "list index out of range");
     }
-    Box* rtn = self->elts->elts[n];
+    Box* rtn = self->getitem(n);
     return rtn;
 }
 
@@ -150,14 +224,14 @@ extern "C" Box* listGetitem(BoxedList* self, Box* slice) {
     } else if (slice->cls == slice_cls) {
         return listGetitemSlice(self, static_cast<BoxedSlice*>(slice));
     } else {
-        raiseExcHelper(TypeError, "list indices must be integers, not %s", getTypeName(slice)->c_str());
+        raiseExcHelper(TypeError, "list indices must be integers, not %s", getTypeName(slice));
     }
 }
 
 
 extern "C" Box* listSetitemInt(BoxedList* self, BoxedInt* slice, Box* v) {
-    // I think r lock is ok here, since we don't change the list structure:
-    LOCK_REGION(self->lock.asRead());
+    // This needs the w lock, since storing an element of a different type can change the list's storage:
+    LOCK_REGION(self->lock.asWrite());
 
     assert(self->cls == list_cls);
     assert(slice->cls == int_cls);
@@ -169,7 +243,7 @@ extern "C" Box* listSetitemInt(BoxedList* self, BoxedInt* slice, Box* v) {
         raiseExcHelper(IndexError, "list index out of range");
     }
 
-    self->elts->elts[n] = v;
+    self->setitem(n, v);
     return None;
 }
 
@@ -186,21 +260,35 @@ extern "C" Box* listSetitemSlice(BoxedList* self, BoxedSlice* slice, Box* v) {
     ASSERT(0 <= stop && stop <= self->size, "%ld %ld", self->size, stop);
     assert(start <= stop);
 
-    ASSERT(v->cls == list_cls, "unsupported %s", getTypeName(v)->c_str());
+    ASSERT(v->cls == list_cls, "unsupported %s", getTypeName(v));
     BoxedList* lv = static_cast<BoxedList*>(v);
+    if (lv == self)
+        lv = static_cast<BoxedList*>(_listSlice(lv, 0, lv->size, 1));
+
+    // If the storage doesn't match, self has to hold objects, and lv's elements get boxed straight
+    // into it:
+    bool same_strategy = lv->size == 0 || lv->strategy == self->strategy;
+    if (!same_strategy)
+        self->convertToObjects();
 
     int delts = lv->size - (stop - start);
     int remaining_elts = self->size - stop;
     self->ensure(delts);
 
     memmove(self->elts->elts + start + lv->size, self->elts->elts + stop, remaining_elts * sizeof(Box*));
-    for (int i = 0; i < lv->size; i++) {
-        Box* r = lv->elts->elts[i];
-        self->elts->elts[start + i] = r;
+    if (same_strategy) {
+        memcpy(self->elts->elts + start, lv->elts->elts, lv->size * sizeof(Box*));
+        self->size += delts;
+    } else {
+        // Boxing can trigger a collection, which only scans the first size elements, so the gap has
+        // to hold valid pointers before the size gets updated:
+        for (int64_t i = 0; i < lv->size; i++)
+            self->elts->elts[start + i] = None;
+        self->size += delts;
+        for (int64_t i = 0; i < lv->size; i++)
+            self->elts->elts[start + i] = lv->getitem(i);
     }
 
-    self->size += delts;
-
     return None;
 }
 
@@ -211,7 +299,7 @@ extern "C" Box* listSetitem(BoxedList* self, Box* slice, Box* v) {
     } else if (slice->cls == slice_cls) {
         return listSetitemSlice(self, static_cast<BoxedSlice*>(slice), v);
     } else {
-        raiseExcHelper(TypeError, "list indices must be integers, not %s", getTypeName(slice)->c_str());
+        raiseExcHelper(TypeError, "list indices must be integers, not %s", getTypeName(slice));
     }
 }
 
@@ -258,7 +346,7 @@ extern "C" Box* listDelitem(BoxedList* self, Box* slice) {
     } else if (slice->cls == slice_cls) {
         rtn = listDelitemSlice(self, static_cast<BoxedSlice*>(slice));
     } else {
-        raiseExcHelper(TypeError, "list indices must be integers, not %s", getTypeName(slice)->c_str());
+        raiseExcHelper(TypeError, "list indices must be integers, not %s", getTypeName(slice));
     }
     self->shrink();
     return rtn;
@@ -283,10 +371,11 @@ extern "C" Box* listInsert(BoxedList* self, Box* idx, Box* v) {
         assert(0 <= n && n < self->size);
 
         self->ensure(1);
+        self->prepareToStore(v);
         memmove(self->elts->elts + n + 1, self->elts->elts + n, (self->size - n) * sizeof(Box*));
 
         self->size++;
-        self->elts->elts[n] = v;
+        self->setitem(n, v);
     }
 
     return None;
@@ -294,7 +383,7 @@ extern "C" Box* listInsert(BoxedList* self, Box* idx, Box* v) {
 
 Box* listMul(BoxedList* self, Box* rhs) {
     if (rhs->cls != int_cls) {
-        raiseExcHelper(TypeError, "can't multiply sequence by non-int of type '%s'", getTypeName(rhs)->c_str());
+        raiseExcHelper(TypeError, "can't multiply sequence by non-int of type '%s'", getTypeName(rhs));
     }
 
     LOCK_REGION(self->lock.asRead());
@@ -304,14 +393,8 @@ Box* listMul(BoxedList* self, Box* rhs) {
 
     BoxedList* rtn = new BoxedList();
     rtn->ensure(n * s);
-    if (s == 1) {
-        for (int i = 0; i < n; i++) {
-            listAppendInternal(rtn, self->elts->elts[0]);
-        }
-    } else {
-        for (int i = 0; i < n; i++) {
-            listAppendArrayInternal(rtn, &self->elts->elts[0], s);
-        }
+    for (int i = 0; i < n; i++) {
+        appendFromList(rtn, self, 0, s);
     }
 
     return rtn;
@@ -319,25 +402,20 @@ Box* listMul(BoxedList* self, Box* rhs) {
 
 Box* listIAdd(BoxedList* self, Box* _rhs) {
     if (_rhs->cls != list_cls) {
-        raiseExcHelper(TypeError, "can only concatenate list (not \"%s\") to list", getTypeName(_rhs)->c_str());
+        raiseExcHelper(TypeError, "can only concatenate list (not \"%s\") to list", getTypeName(_rhs));
     }
 
     LOCK_REGION(self->lock.asWrite());
 
     BoxedList* rhs = static_cast<BoxedList*>(_rhs);
 
-    int s1 = self->size;
-    int s2 = rhs->size;
-    self->ensure(s1 + s2);
-
-    memcpy(self->elts->elts + s1, rhs->elts->elts, sizeof(rhs->elts->elts[0]) * s2);
-    self->size = s1 + s2;
+    appendFromList(self, rhs, 0, rhs->size);
     return self;
 }
 
 Box* listAdd(BoxedList* self, Box* _rhs) {
     if (_rhs->cls != list_cls) {
-        raiseExcHelper(TypeError, "can only concatenate list (not \"%s\") to list", getTypeName(_rhs)->c_str());
+        raiseExcHelper(TypeError, "can only concatenate list (not \"%s\") to list", getTypeName(_rhs));
     }
 
     LOCK_REGION(self->lock.asRead());
@@ -346,23 +424,170 @@ Box* listAdd(BoxedList* self, Box* _rhs) {
 
     BoxedList* rtn = new BoxedList();
 
-    int s1 = self->size;
-    int s2 = rhs->size;
-    rtn->ensure(s1 + s2);
-
-    memcpy(rtn->elts->elts, self->elts->elts, sizeof(self->elts->elts[0]) * s1);
-    memcpy(rtn->elts->elts + s1, rhs->elts->elts, sizeof(rhs->elts->elts[0]) * s2);
-    rtn->size = s1 + s2;
+    rtn->ensure(self->size + rhs->size);
+    appendFromList(rtn, self, 0, self->size);
+    appendFromList(rtn, rhs, 0, rhs->size);
     return rtn;
 }
 
-Box* listSort1(BoxedList* self) {
-    LOCK_REGION(self->lock.asWrite());
+namespace {
+// What gets sorted when there's a key function: the key is computed once per element, up front.
+struct KeyedItem {
+    Box* key;
+    Box* value;
+};
+
+Box* sortKey(Box* b) {
+    return b;
+}
+Box* sortKey(const KeyedItem& item) {
+    return item.key;
+}
+
+// Comparisons for when all of the sort keys are of the same builtin type, which don't have to go
+// through compareInternal (and can't run any user code):
+struct IntLt {
+    bool operator()(Box* lhs, Box* rhs) const {
+        return static_cast<BoxedInt*>(lhs)->n < static_cast<BoxedInt*>(rhs)->n;
+    }
+};
+struct FloatLt {
+    bool operator()(Box* lhs, Box* rhs) const {
+        return static_cast<BoxedFloat*>(lhs)->d < static_cast<BoxedFloat*>(rhs)->d;
+    }
+};
+struct StrLt {
+    bool operator()(Box* lhs, Box* rhs) const {
+        return static_cast<BoxedString*>(lhs)->s < static_cast<BoxedString*>(rhs)->s;
+    }
+};
+struct ObjectLt {
+    bool operator()(Box* lhs, Box* rhs) const { return nonzero(compareInternal(lhs, rhs, AST_TYPE::Lt, NULL)); }
+};
+
+template <typename Lt> struct SortItemLt {
+    template <typename T> bool operator()(const T& lhs, const T& rhs) const { return Lt()(sortKey(lhs), sortKey(rhs)); }
+};
+
+template <typename T> void sortItems(T* items, int64_t n) {
+    if (n < 2)
+        return;
+
+    BoxedClass* cls = sortKey(items[0])->cls;
+    for (int64_t i = 1; i < n; i++) {
+        if (sortKey(items[i])->cls != cls) {
+            cls = NULL;
+            break;
+        }
+    }
+
+    if (cls == int_cls)
+        timsort(items, n, SortItemLt<IntLt>());
+    else if (cls == float_cls)
+        timsort(items, n, SortItemLt<FloatLt>());
+    else if (cls == str_cls)
+        timsort(items, n, SortItemLt<StrLt>());
+    else
+        timsort(items, n, SortItemLt<ObjectLt>());
+}
+
+void sortElements(BoxedList* self, Box* key) {
+    int64_t n = self->size;
+    if (key == None) {
+        if (self->strategy == BoxedList::INT)
+            timsort(self->elts->ints(), n, std::less<int64_t>());
+        else if (self->strategy == BoxedList::FLOAT)
+            timsort(self->elts->floats(), n, std::less<double>());
+        else
+            sortItems(self->elts->elts, n);
+        return;
+    }
 
+    KeyedItem* items = (KeyedItem*)gc::gc_alloc(n * sizeof(KeyedItem), gc::GCKind::CONSERVATIVE);
+    for (int64_t i = 0; i < n; i++) {
+        items[i].value = self->getitem(i);
+        items[i].key = runtimeCall(key, ArgPassSpec(1), items[i].value, NULL, NULL, NULL, NULL);
+    }
+
+    sortItems(items, n);
+
+    for (int64_t i = 0; i < n; i++)
+        self->setitem(i, items[i].value);
+    gc::gc_free(items);
+}
+}
+
+static void reverseElements(BoxedList* self) {
+    if (self->strategy == BoxedList::INT)
+        std::reverse(self->elts->ints(), self->elts->ints() + self->size);
+    else if (self->strategy == BoxedList::FLOAT)
+        std::reverse(self->elts->floats(), self->elts->floats() + self->size);
+    else
+        std::reverse(self->elts->elts, self->elts->elts + self->size);
+}
+
+// Moves the sorted elements back into self.  Returns whether anything got added to self in the meantime,
+// which gets thrown away.
+static bool restoreAfterSort(BoxedList* self, BoxedList* sorting) {
+    bool modified = self->size != 0 || self->capacity != 0;
+    self->elts = sorting->elts;
+    self->size = sorting->size;
+    self->capacity = sorting->capacity;
+    self->strategy = sorting->strategy;
+    sorting->size = sorting->capacity = 0;
+    return modified;
+}
+
+// list.sort(key=None, reverse=False)
+Box* listSort(BoxedList* self, BoxedDict* kwargs) {
     assert(self->cls == list_cls);
+    assert(kwargs->cls == dict_cls);
+
+    Box* key = None;
+    bool reverse = false;
+    for (const auto& p : kwargs->d) {
+        if (p.first->cls != str_cls)
+            raiseExcHelper(TypeError, "keywords must be strings");
+        llvm::StringRef name = static_cast<BoxedString*>(p.first)->s;
+        if (name == "key")
+            key = p.second;
+        else if (name == "reverse")
+            reverse = nonzero(p.second);
+        else
+            raiseExcHelper(TypeError, "'%s' is an invalid keyword argument for this function", name.data());
+    }
 
-    std::sort<Box**, PyLt>(self->elts->elts, self->elts->elts + self->size, PyLt());
+    LOCK_REGION(self->lock.asWrite());
 
+    if (self->size == 0)
+        return None;
+
+    // The key function and the comparisons can run arbitrary code, which could change the list out
+    // from under the sort (and even free the array being sorted), so like CPython, move the elements
+    // into a temporary list while sorting and leave self empty.
+    BoxedList* sorting = new BoxedList();
+    std::swap(sorting->elts, self->elts);
+    std::swap(sorting->size, self->size);
+    std::swap(sorting->capacity, self->capacity);
+    std::swap(sorting->strategy, self->strategy);
+
+    // Reversing before and after the sort (rather than sorting with a reversed comparison) keeps
+    // equal elements in their original order.
+    if (reverse)
+        reverseElements(sorting);
+    try {
+        sortElements(sorting, key);
+    } catch (Box* b) {
+        if (reverse)
+            reverseElements(sorting);
+        restoreAfterSort(self, sorting);
+        throw;
+    }
+    if (reverse)
+        reverseElements(sorting);
+    bool modified = restoreAfterSort(self, sorting);
+    if (modified)
+        raiseExcHelper(ValueError, "list modified during sort");
     return None;
 }
 
@@ -371,7 +596,7 @@ Box* listContains(BoxedList* self, Box* elt) {
 
     int size = self->size;
     for (int i = 0; i < size; i++) {
-        Box* e = self->elts->elts[i];
+        Box* e = self->getitem(i);
         Box* cmp = compareInternal(e, elt, AST_TYPE::Eq, NULL);
         bool b = nonzero(cmp);
         if (b)
@@ -387,7 +612,7 @@ Box* listCount(BoxedList* self, Box* elt) {
     int count = 0;
 
     for (int i = 0; i < size; i++) {
-        Box* e = self->elts->elts[i];
+        Box* e = self->getitem(i);
         Box* cmp = compareInternal(e, elt, AST_TYPE::Eq, NULL);
         bool b = nonzero(cmp);
         if (b)
@@ -402,7 +627,7 @@ Box* listIndex(BoxedList* self, Box* elt) {
     int size = self->size;
 
     for (int i = 0; i < size; i++) {
-        Box* e = self->elts->elts[i];
+        Box* e = self->getitem(i);
         Box* cmp = compareInternal(e, elt, AST_TYPE::Eq, NULL);
         bool b = nonzero(cmp);
         if (b)
@@ -410,7 +635,7 @@ Box* listIndex(BoxedList* self, Box* elt) {
     }
 
     BoxedString* tostr = static_cast<BoxedString*>(repr(elt));
-    raiseExcHelper(ValueError, "%s is not in list", tostr->s.c_str());
+    raiseExcHelper(ValueError, "%s is not in list", tostr->c_str());
 }
 
 Box* listRemove(BoxedList* self, Box* elt) {
@@ -419,7 +644,7 @@ Box* listRemove(BoxedList* self, Box* elt) {
     assert(self->cls == list_cls);
 
     for (int i = 0; i < self->size; i++) {
-        Box* e = self->elts->elts[i];
+        Box* e = self->getitem(i);
         Box* cmp = compareInternal(e, elt, AST_TYPE::Eq, NULL);
         bool b = nonzero(cmp);
 
@@ -437,11 +662,7 @@ Box* listReverse(BoxedList* self) {
     LOCK_REGION(self->lock.asWrite());
 
     assert(self->cls == list_cls);
-    for (int i = 0, j = self->size - 1; i < j; i++, j--) {
-        Box* e = self->elts->elts[i];
-        self->elts->elts[i] = self->elts->elts[j];
-        self->elts->elts[j] = e;
-    }
+    reverseElements(self);
 
     return None;
 }
@@ -475,7 +696,7 @@ Box* _listCmp(BoxedList* lhs, BoxedList* rhs, AST_TYPE::AST_TYPE op_type) {
 
     int n = std::min(lsz, rsz);
     for (int i = 0; i < n; i++) {
-        Box* is_eq = compareInternal(lhs->elts->elts[i], rhs->elts->elts[i], AST_TYPE::Eq, NULL);
+        Box* is_eq = compareInternal(lhs->getitem(i), rhs->getitem(i), AST_TYPE::Eq, NULL);
         bool bis_eq = nonzero(is_eq);
 
         if (bis_eq)
@@ -486,7 +707,7 @@ Box* _listCmp(BoxedList* lhs, BoxedList* rhs, AST_TYPE::AST_TYPE op_type) {
         } else if (op_type == AST_TYPE::NotEq) {
             return boxBool(true);
         } else {
-            Box* r = compareInternal(lhs->elts->elts[i], rhs->elts->elts[i], op_type, NULL);
+            Box* r = compareInternal(lhs->getitem(i), rhs->getitem(i), op_type, NULL);
             return r;
         }
     }
@@ -562,7 +783,7 @@ void setupList() {
     list_cls->giveAttr("__iadd__", new BoxedFunction(boxRTFunction((void*)listIAdd, UNKNOWN, 2)));
     list_cls->giveAttr("__add__", new BoxedFunction(boxRTFunction((void*)listAdd, UNKNOWN, 2)));
 
-    list_cls->giveAttr("sort", new BoxedFunction(boxRTFunction((void*)listSort1, NONE, 1)));
+    list_cls->giveAttr("sort", new BoxedFunction(boxRTFunction((void*)listSort, NONE, 1, 0, false, true)));
     list_cls->giveAttr("__contains__", new BoxedFunction(boxRTFunction((void*)listContains, BOXED_BOOL, 2)));
 
     list_cls->giveAttr("__new__",
@@ -34,6 +34,8 @@ Box* listiterHasnext(Box* self);
 i1 listiterHasnextUnboxed(Box* self);
 Box* listiterNext(Box* self);
 extern "C" Box* listAppend(Box* self, Box* v);
+Box* listIAdd(BoxedList* self, Box* _rhs);
+Box* listSort(BoxedList* self, BoxedDict* kwargs);
 }
 
 #endif
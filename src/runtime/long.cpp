@@ -48,12 +48,12 @@ extern "C" BoxedLong* boxLong(int64_t n) {
 
 extern "C" Box* longNew(Box* _cls, Box* val) {
     if (!isSubclass(_cls->cls, type_cls))
-        raiseExcHelper(TypeError, "long.__new__(X): X is not a type object (%s)", getTypeName(_cls)->c_str());
+        raiseExcHelper(TypeError, "long.__new__(X): X is not a type object (%s)", getTypeName(_cls));
 
     BoxedClass* cls = static_cast<BoxedClass*>(_cls);
     if (!isSubclass(cls, long_cls))
-        raiseExcHelper(TypeError, "long.__new__(%s): %s is not a subtype of long", getNameOfClass(cls)->c_str(),
-                       getNameOfClass(cls)->c_str());
+        raiseExcHelper(TypeError, "long.__new__(%s): %s is not a subtype of long", getNameOfClass(cls),
+                       getNameOfClass(cls));
 
     assert(cls->tp_basicsize >= sizeof(BoxedInt));
     void* mem = gc_alloc(cls->tp_basicsize, gc::GCKind::PYTHON);
@@ -63,12 +63,11 @@ extern "C" Box* longNew(Box* _cls, Box* val) {
     if (val->cls == int_cls) {
         mpz_init_set_si(rtn->n, static_cast<BoxedInt*>(val)->n);
     } else if (val->cls == str_cls) {
-        const std::string& s = static_cast<BoxedString*>(val)->s;
-        int r = mpz_init_set_str(rtn->n, s.c_str(), 10);
+        int r = mpz_init_set_str(rtn->n, static_cast<BoxedString*>(val)->c_str(), 10);
         RELEASE_ASSERT(r == 0, "");
     } else {
         fprintf(stderr, "TypeError: int() argument must be a string or a number, not '%s'\n",
-                getTypeName(val)->c_str());
+                getTypeName(val));
         raiseExcHelper(TypeError, "");
     }
     return rtn;
@@ -77,7 +76,7 @@ extern "C" Box* longNew(Box* _cls, Box* val) {
 Box* longRepr(BoxedLong* v) {
     if (!isSubclass(v->cls, long_cls))
         raiseExcHelper(TypeError, "descriptor '__repr__' requires a 'long' object but received a '%s'",
-                       getTypeName(v)->c_str());
+                       getTypeName(v));
 
     int space_required = mpz_sizeinbase(v->n, 10) + 2; // basic size
     space_required += 1;                               // 'L' suffix
@@ -85,7 +84,7 @@ Box* longRepr(BoxedLong* v) {
     mpz_get_str(buf, 10, v->n);
     strcat(buf, "L");
 
-    auto rtn = new BoxedString(buf);
+    auto rtn = boxString(buf);
     free(buf);
 
     return rtn;
@@ -94,10 +93,10 @@ Box* longRepr(BoxedLong* v) {
 Box* longStr(BoxedLong* v) {
     if (!isSubclass(v->cls, long_cls))
         raiseExcHelper(TypeError, "descriptor '__str__' requires a 'long' object but received a '%s'",
-                       getTypeName(v)->c_str());
+                       getTypeName(v));
 
     char* buf = mpz_get_str(NULL, 10, v->n);
-    auto rtn = new BoxedString(buf);
+    auto rtn = boxString(buf);
     free(buf);
 
     return rtn;
@@ -106,7 +105,7 @@ Box* longStr(BoxedLong* v) {
 Box* longNeg(BoxedLong* v1) {
     if (!isSubclass(v1->cls, long_cls))
         raiseExcHelper(TypeError, "descriptor '__neg__' requires a 'long' object but received a '%s'",
-                       getTypeName(v1)->c_str());
+                       getTypeName(v1));
 
     BoxedLong* r = new BoxedLong(long_cls);
     mpz_init(r->n);
@@ -114,92 +113,263 @@ Box* longNeg(BoxedLong* v1) {
     return r;
 }
 
+// Helpers for the mixed long/int paths: these operate on the int's value directly
+// rather than boxing it into a temporary long first.
+static void mpzAddI64(mpz_t r, mpz_t lhs, i64 rhs) {
+    if (rhs >= 0)
+        mpz_add_ui(r, lhs, rhs);
+    else
+        mpz_sub_ui(r, lhs, -(uint64_t)rhs);
+}
+
+static void mpzSubI64(mpz_t r, mpz_t lhs, i64 rhs) {
+    if (rhs >= 0)
+        mpz_sub_ui(r, lhs, rhs);
+    else
+        mpz_add_ui(r, lhs, -(uint64_t)rhs);
+}
+
 Box* longAdd(BoxedLong* v1, Box* _v2) {
     if (!isSubclass(v1->cls, long_cls))
         raiseExcHelper(TypeError, "descriptor '__add__' requires a 'long' object but received a '%s'",
-                       getTypeName(v1)->c_str());
-
-    if (!isSubclass(_v2->cls, long_cls))
+                       getTypeName(v1));
+
+    if (isSubclass(_v2->cls, long_cls)) {
+        BoxedLong* v2 = static_cast<BoxedLong*>(_v2);
+
+        BoxedLong* r = new BoxedLong(long_cls);
+        mpz_init(r->n);
+        mpz_add(r->n, v1->n, v2->n);
+        return r;
+    } else if (isSubclass(_v2->cls, int_cls)) {
+        BoxedInt* v2 = static_cast<BoxedInt*>(_v2);
+
+        BoxedLong* r = new BoxedLong(long_cls);
+        mpz_init(r->n);
+        mpzAddI64(r->n, v1->n, v2->n);
+        return r;
+    } else {
         return NotImplemented;
-
-    BoxedLong* v2 = static_cast<BoxedLong*>(_v2);
-
-    BoxedLong* r = new BoxedLong(long_cls);
-    mpz_init(r->n);
-    mpz_add(r->n, v1->n, v2->n);
-    return r;
+    }
 }
 
 Box* longSub(BoxedLong* v1, Box* _v2) {
     if (!isSubclass(v1->cls, long_cls))
         raiseExcHelper(TypeError, "descriptor '__sub__' requires a 'long' object but received a '%s'",
-                       getTypeName(v1)->c_str());
+                       getTypeName(v1));
+
+    if (isSubclass(_v2->cls, long_cls)) {
+        BoxedLong* v2 = static_cast<BoxedLong*>(_v2);
+
+        BoxedLong* r = new BoxedLong(long_cls);
+        mpz_init(r->n);
+        mpz_sub(r->n, v1->n, v2->n);
+        return r;
+    } else if (isSubclass(_v2->cls, int_cls)) {
+        BoxedInt* v2 = static_cast<BoxedInt*>(_v2);
+
+        BoxedLong* r = new BoxedLong(long_cls);
+        mpz_init(r->n);
+        mpzSubI64(r->n, v1->n, v2->n);
+        return r;
+    } else {
+        return NotImplemented;
+    }
+}
 
-    if (!isSubclass(_v2->cls, long_cls))
+Box* longRSub(BoxedLong* v1, Box* _v2) {
+    if (!isSubclass(v1->cls, long_cls))
+        raiseExcHelper(TypeError, "descriptor '__rsub__' requires a 'long' object but received a '%s'",
+                       getTypeName(v1));
+
+    if (!isSubclass(_v2->cls, int_cls))
         return NotImplemented;
 
-    BoxedLong* v2 = static_cast<BoxedLong*>(_v2);
+    BoxedInt* v2 = static_cast<BoxedInt*>(_v2);
 
+    // v2 - v1 == -(v1 - v2)
     BoxedLong* r = new BoxedLong(long_cls);
     mpz_init(r->n);
-    mpz_sub(r->n, v1->n, v2->n);
+    mpzSubI64(r->n, v1->n, v2->n);
+    mpz_neg(r->n, r->n);
     return r;
 }
 
 Box* longMul(BoxedLong* v1, Box* _v2) {
     if (!isSubclass(v1->cls, long_cls))
         raiseExcHelper(TypeError, "descriptor '__mul__' requires a 'long' object but received a '%s'",
-                       getTypeName(v1)->c_str());
+                       getTypeName(v1));
+
+    if (isSubclass(_v2->cls, long_cls)) {
+        BoxedLong* v2 = static_cast<BoxedLong*>(_v2);
+
+        BoxedLong* r = new BoxedLong(long_cls);
+        mpz_init(r->n);
+        mpz_mul(r->n, v1->n, v2->n);
+        return r;
+    } else if (isSubclass(_v2->cls, int_cls)) {
+        BoxedInt* v2 = static_cast<BoxedInt*>(_v2);
+
+        BoxedLong* r = new BoxedLong(long_cls);
+        mpz_init(r->n);
+        mpz_mul_si(r->n, v1->n, v2->n);
+        return r;
+    } else {
+        return NotImplemented;
+    }
+}
 
-    if (!isSubclass(_v2->cls, long_cls))
+Box* longDiv(BoxedLong* v1, Box* _v2) {
+    if (!isSubclass(v1->cls, long_cls))
+        raiseExcHelper(TypeError, "descriptor '__div__' requires a 'long' object but received a '%s'",
+                       getTypeName(v1));
+
+    if (isSubclass(_v2->cls, long_cls)) {
+        BoxedLong* v2 = static_cast<BoxedLong*>(_v2);
+
+        if (mpz_cmp_si(v2->n, 0) == 0)
+            raiseExcHelper(ZeroDivisionError, "long division or modulo by zero");
+
+        BoxedLong* r = new BoxedLong(long_cls);
+        mpz_init(r->n);
+        // It looks like the 'f'-family of integer functions ("floor") do the Python-style rounding
+        mpz_fdiv_q(r->n, v1->n, v2->n);
+        return r;
+    } else if (isSubclass(_v2->cls, int_cls)) {
+        BoxedInt* v2 = static_cast<BoxedInt*>(_v2);
+
+        if (v2->n == 0)
+            raiseExcHelper(ZeroDivisionError, "long division or modulo by zero");
+
+        BoxedLong* r = new BoxedLong(long_cls);
+        mpz_init(r->n);
+        if (v2->n > 0) {
+            mpz_fdiv_q_ui(r->n, v1->n, v2->n);
+        } else {
+            // floor(a / -b) == -ceil(a / b)
+            mpz_cdiv_q_ui(r->n, v1->n, -(uint64_t)v2->n);
+            mpz_neg(r->n, r->n);
+        }
+        return r;
+    } else {
         return NotImplemented;
+    }
+}
+
+// Like CPython, a negative exponent makes the result a float.
+static Box* longPowNegative(BoxedLong* v1, double exp) {
+    double base = mpz_get_d(v1->n);
+    if (base == 0)
+        raiseExcHelper(ZeroDivisionError, "0.0 cannot be raised to a negative power");
+    return boxFloat(pow(base, exp));
+}
 
-    BoxedLong* v2 = static_cast<BoxedLong*>(_v2);
+Box* longPow(BoxedLong* v1, Box* _v2) {
+    if (!isSubclass(v1->cls, long_cls))
+        raiseExcHelper(TypeError, "descriptor '__pow__' requires a 'long' object but received a '%s'",
+                       getTypeName(v1));
+
+    uint64_t n2;
+    if (isSubclass(_v2->cls, long_cls)) {
+        BoxedLong* v2 = static_cast<BoxedLong*>(_v2);
+
+        if (mpz_sgn(v2->n) < 0)
+            return longPowNegative(v1, mpz_get_d(v2->n));
+        RELEASE_ASSERT(mpz_fits_ulong_p(v2->n), "");
+        n2 = mpz_get_ui(v2->n);
+    } else if (isSubclass(_v2->cls, int_cls)) {
+        BoxedInt* v2 = static_cast<BoxedInt*>(_v2);
+
+        if (v2->n < 0)
+            return longPowNegative(v1, v2->n);
+        n2 = v2->n;
+    } else {
+        return NotImplemented;
+    }
 
     BoxedLong* r = new BoxedLong(long_cls);
     mpz_init(r->n);
-    mpz_mul(r->n, v1->n, v2->n);
+    mpz_pow_ui(r->n, v1->n, n2);
     return r;
 }
 
-Box* longDiv(BoxedLong* v1, Box* _v2) {
+// Compares v1 against a long or int v2, putting the sign of (v1 - v2) into 'cmp'.
+// Returns false if v2 isn't a type we know how to compare against.
+static bool longCompare(BoxedLong* v1, Box* _v2, int& cmp) {
+    if (isSubclass(_v2->cls, long_cls)) {
+        cmp = mpz_cmp(v1->n, static_cast<BoxedLong*>(_v2)->n);
+        return true;
+    } else if (isSubclass(_v2->cls, int_cls)) {
+        cmp = mpz_cmp_si(v1->n, static_cast<BoxedInt*>(_v2)->n);
+        return true;
+    }
+    return false;
+}
+
+Box* longEq(BoxedLong* v1, Box* _v2) {
     if (!isSubclass(v1->cls, long_cls))
-        raiseExcHelper(TypeError, "descriptor '__div__' requires a 'long' object but received a '%s'",
-                       getTypeName(v1)->c_str());
+        raiseExcHelper(TypeError, "descriptor '__eq__' requires a 'long' object but received a '%s'",
+                       getTypeName(v1));
 
-    if (!isSubclass(_v2->cls, long_cls))
+    int cmp;
+    if (!longCompare(v1, _v2, cmp))
         return NotImplemented;
+    return boxBool(cmp == 0);
+}
 
-    BoxedLong* v2 = static_cast<BoxedLong*>(_v2);
+Box* longNe(BoxedLong* v1, Box* _v2) {
+    if (!isSubclass(v1->cls, long_cls))
+        raiseExcHelper(TypeError, "descriptor '__ne__' requires a 'long' object but received a '%s'",
+                       getTypeName(v1));
 
-    if (mpz_cmp_si(v2->n, 0) == 0)
-        raiseExcHelper(ZeroDivisionError, "long division or modulo by zero");
+    int cmp;
+    if (!longCompare(v1, _v2, cmp))
+        return NotImplemented;
+    return boxBool(cmp != 0);
+}
 
-    BoxedLong* r = new BoxedLong(long_cls);
-    mpz_init(r->n);
-    // It looks like the 'f'-family of integer functions ("floor") do the Python-style rounding
-    mpz_fdiv_q(r->n, v1->n, v2->n);
-    return r;
+Box* longLt(BoxedLong* v1, Box* _v2) {
+    if (!isSubclass(v1->cls, long_cls))
+        raiseExcHelper(TypeError, "descriptor '__lt__' requires a 'long' object but received a '%s'",
+                       getTypeName(v1));
+
+    int cmp;
+    if (!longCompare(v1, _v2, cmp))
+        return NotImplemented;
+    return boxBool(cmp < 0);
 }
 
-Box* longPow(BoxedLong* v1, Box* _v2) {
+Box* longLe(BoxedLong* v1, Box* _v2) {
     if (!isSubclass(v1->cls, long_cls))
-        raiseExcHelper(TypeError, "descriptor '__pow__' requires a 'long' object but received a '%s'",
-                       getTypeName(v1)->c_str());
+        raiseExcHelper(TypeError, "descriptor '__le__' requires a 'long' object but received a '%s'",
+                       getTypeName(v1));
 
-    if (!isSubclass(_v2->cls, long_cls))
+    int cmp;
+    if (!longCompare(v1, _v2, cmp))
         return NotImplemented;
+    return boxBool(cmp <= 0);
+}
+
+Box* longGt(BoxedLong* v1, Box* _v2) {
+    if (!isSubclass(v1->cls, long_cls))
+        raiseExcHelper(TypeError, "descriptor '__gt__' requires a 'long' object but received a '%s'",
+                       getTypeName(v1));
 
-    BoxedLong* v2 = static_cast<BoxedLong*>(_v2);
+    int cmp;
+    if (!longCompare(v1, _v2, cmp))
+        return NotImplemented;
+    return boxBool(cmp > 0);
+}
 
-    RELEASE_ASSERT(mpz_sgn(v2->n) >= 0, "");
-    RELEASE_ASSERT(mpz_fits_ulong_p(v2->n), "");
-    uint64_t n2 = mpz_get_ui(v2->n);
+Box* longGe(BoxedLong* v1, Box* _v2) {
+    if (!isSubclass(v1->cls, long_cls))
+        raiseExcHelper(TypeError, "descriptor '__ge__' requires a 'long' object but received a '%s'",
+                       getTypeName(v1));
 
-    BoxedLong* r = new BoxedLong(long_cls);
-    mpz_init(r->n);
-    mpz_pow_ui(r->n, v1->n, n2);
-    return r;
+    int cmp;
+    if (!longCompare(v1, _v2, cmp))
+        return NotImplemented;
+    return boxBool(cmp >= 0);
 }
 
 void setupLong() {
@@ -208,8 +378,23 @@ void setupLong() {
     long_cls->giveAttr("__new__",
                        new BoxedFunction(boxRTFunction((void*)longNew, UNKNOWN, 2, 1, false, false), { boxInt(0) }));
 
+    long_cls->giveAttr("__neg__", new BoxedFunction(boxRTFunction((void*)longNeg, UNKNOWN, 1)));
+
+    long_cls->giveAttr("__add__", new BoxedFunction(boxRTFunction((void*)longAdd, UNKNOWN, 2)));
+    long_cls->giveAttr("__radd__", long_cls->getattr("__add__"));
+    long_cls->giveAttr("__sub__", new BoxedFunction(boxRTFunction((void*)longSub, UNKNOWN, 2)));
+    long_cls->giveAttr("__rsub__", new BoxedFunction(boxRTFunction((void*)longRSub, UNKNOWN, 2)));
     long_cls->giveAttr("__mul__", new BoxedFunction(boxRTFunction((void*)longMul, UNKNOWN, 2)));
+    long_cls->giveAttr("__rmul__", long_cls->getattr("__mul__"));
     long_cls->giveAttr("__div__", new BoxedFunction(boxRTFunction((void*)longDiv, UNKNOWN, 2)));
+    long_cls->giveAttr("__pow__", new BoxedFunction(boxRTFunction((void*)longPow, UNKNOWN, 2)));
+
+    long_cls->giveAttr("__eq__", new BoxedFunction(boxRTFunction((void*)longEq, UNKNOWN, 2)));
+    long_cls->giveAttr("__ne__", new BoxedFunction(boxRTFunction((void*)longNe, UNKNOWN, 2)));
+    long_cls->giveAttr("__lt__", new BoxedFunction(boxRTFunction((void*)longLt, UNKNOWN, 2)));
+    long_cls->giveAttr("__le__", new BoxedFunction(boxRTFunction((void*)longLe, UNKNOWN, 2)));
+    long_cls->giveAttr("__gt__", new BoxedFunction(boxRTFunction((void*)longGt, UNKNOWN, 2)));
+    long_cls->giveAttr("__ge__", new BoxedFunction(boxRTFunction((void*)longGe, UNKNOWN, 2)));
 
     long_cls->giveAttr("__repr__", new BoxedFunction(boxRTFunction((void*)longRepr, STR, 1)));
     long_cls->giveAttr("__str__", new BoxedFunction(boxRTFunction((void*)longStr, STR, 1)));
@@ -40,9 +40,17 @@ Box* longNeg(BoxedLong* lhs);
 
 Box* longAdd(BoxedLong* lhs, Box* rhs);
 Box* longSub(BoxedLong* lhs, Box* rhs);
+Box* longRSub(BoxedLong* lhs, Box* rhs);
 Box* longMul(BoxedLong* lhs, Box* rhs);
 Box* longDiv(BoxedLong* lhs, Box* rhs);
 Box* longPow(BoxedLong* lhs, Box* rhs);
+
+Box* longEq(BoxedLong* lhs, Box* rhs);
+Box* longNe(BoxedLong* lhs, Box* rhs);
+Box* longLt(BoxedLong* lhs, Box* rhs);
+Box* longLe(BoxedLong* lhs, Box* rhs);
+Box* longGt(BoxedLong* lhs, Box* rhs);
+Box* longGe(BoxedLong* lhs, Box* rhs);
 }
 
 #endif
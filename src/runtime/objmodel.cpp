@@ -20,6 +20,7 @@
 #include <cstring>
 #include <memory>
 #include <stdint.h>
+#include <unordered_set>
 
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
@@ -46,6 +47,7 @@
 #define BOX_CLS_OFFSET ((char*)&(((Box*)0x01)->cls) - (char*)0x1)
 #define HCATTRS_HCLS_OFFSET ((char*)&(((HCAttrs*)0x01)->hcls) - (char*)0x1)
 #define HCATTRS_ATTRS_OFFSET ((char*)&(((HCAttrs*)0x01)->attr_list) - (char*)0x1)
+#define HCATTRS_INLINE_ATTRS_OFFSET (sizeof(HCAttrs))
 #define ATTRLIST_ATTRS_OFFSET ((char*)&(((HCAttrs::AttrList*)0x01)->attrs) - (char*)0x1)
 #define ATTRLIST_KIND_OFFSET ((char*)&(((HCAttrs::AttrList*)0x01)->gc_header.kind_id) - (char*)0x1)
 #define INSTANCEMETHOD_FUNC_OFFSET ((char*)&(((BoxedInstanceMethod*)0x01)->func) - (char*)0x1)
@@ -260,10 +262,8 @@ static Box* (*callattrInternal3)(Box*, const std::string*, LookupScope, CallRewr
        * (*)(Box*, const std::string*, LookupScope, CallRewriteArgs*, ArgPassSpec, Box*, Box*, Box*))callattrInternal;
 
 size_t PyHasher::operator()(Box* b) const {
-    if (b->cls == str_cls) {
-        std::hash<std::string> H;
-        return H(static_cast<BoxedString*>(b)->s);
-    }
+    if (b->cls == str_cls)
+        return static_cast<BoxedString*>(b)->hash();
 
     BoxedInt* i = hash(b);
     assert(sizeof(size_t) == sizeof(i->n));
@@ -274,7 +274,7 @@ size_t PyHasher::operator()(Box* b) const {
 bool PyEq::operator()(Box* lhs, Box* rhs) const {
     if (lhs->cls == rhs->cls) {
         if (lhs->cls == str_cls) {
-            return static_cast<BoxedString*>(lhs)->s == static_cast<BoxedString*>(rhs)->s;
+            return BoxedString::equal(static_cast<BoxedString*>(lhs), static_cast<BoxedString*>(rhs));
         }
     }
 
@@ -312,7 +312,7 @@ extern "C" bool isSubclass(BoxedClass* child, BoxedClass* parent) {
 extern "C" void assertFail(BoxedModule* inModule, Box* msg) {
     if (msg) {
         BoxedString* tostr = str(msg);
-        raiseExcHelper(AssertionError, "%s", tostr->s.c_str());
+        raiseExcHelper(AssertionError, "%s", tostr->c_str());
     } else {
         raiseExcHelper(AssertionError, NULL);
     }
@@ -335,9 +335,9 @@ extern "C" void raiseAttributeError(Box* obj, const char* attr) {
     if (obj->cls == type_cls) {
         // Slightly different error message:
         raiseExcHelper(AttributeError, "type object '%s' has no attribute '%s'",
-                       getNameOfClass(static_cast<BoxedClass*>(obj))->c_str(), attr);
+                       getNameOfClass(static_cast<BoxedClass*>(obj)), attr);
     } else {
-        raiseAttributeErrorStr(getTypeName(obj)->c_str(), attr);
+        raiseAttributeErrorStr(getTypeName(obj), attr);
     }
 }
 
@@ -362,7 +362,7 @@ extern "C" void checkUnpackingLength(i64 expected, i64 given) {
 BoxedClass::BoxedClass(BoxedClass* base, gcvisit_func gc_visit, int attrs_offset, int instance_size,
                        bool is_user_defined)
     : Box(type_cls), tp_basicsize(instance_size), tp_dealloc(NULL), base(base), gc_visit(gc_visit),
-      attrs_offset(attrs_offset), is_constant(false), is_user_defined(is_user_defined) {
+      attrs_offset(attrs_offset), is_constant(false), is_user_defined(is_user_defined), num_inline_attrs(0) {
     assert(tp_dealloc == NULL);
 
     if (gc_visit == NULL) {
@@ -395,29 +395,141 @@ BoxedClass::BoxedClass(BoxedClass* base, gcvisit_func gc_visit, int attrs_offset
         gc::registerStaticRootObj(this);
 }
 
-extern "C" const std::string* getNameOfClass(BoxedClass* cls) {
+extern "C" const char* getNameOfClass(BoxedClass* cls) {
     Box* b = cls->getattr("__name__");
     assert(b);
     ASSERT(b->cls == str_cls, "%p", b->cls);
     BoxedString* sb = static_cast<BoxedString*>(b);
-    return &sb->s;
+    return sb->c_str();
 }
 
-extern "C" const std::string* getTypeName(Box* o) {
+extern "C" const char* getTypeName(Box* o) {
     return getNameOfClass(o->cls);
 }
 
-HiddenClass* HiddenClass::getOrMakeChild(const std::string& attr) {
-    std::unordered_map<std::string, HiddenClass*>::iterator it = children.find(attr);
-    if (it != children.end())
-        return it->second;
+HiddenClass* HiddenClass::getInlineRoot(int num_inline) {
+    assert(num_inline >= 0 && num_inline <= MAX_INLINE_ATTRS);
+    if (num_inline == 0)
+        return root_hcls;
+
+    static HiddenClass* inline_roots[MAX_INLINE_ATTRS + 1];
+    HiddenClass*& root = inline_roots[num_inline];
+    if (!root) {
+        root = new HiddenClass(num_inline);
+        gc::registerStaticRootObj(root);
+    }
+    return root;
+}
+
+namespace {
+struct InternedAttrNames {
+    // unordered_set never moves its elements, so we can hand out pointers to them:
+    std::unordered_set<std::string> names;
+    // Callers on the hot paths (ex attribute names embedded in jitted code) pass in the interned
+    // copy itself, which we can recognize by its address without having to hash the contents.
+    // Interned strings are never freed, so no other string can end up at one of these addresses.
+    std::unordered_set<const std::string*> ptrs;
+};
+
+InternedAttrNames& getInternedAttrNames() {
+    static InternedAttrNames interned;
+    return interned;
+}
+}
+
+const std::string* internAttrName(const std::string& name) {
+    InternedAttrNames& interned = getInternedAttrNames();
+    if (interned.ptrs.count(&name))
+        return &name;
+
+    const std::string* rtn = &*interned.names.insert(name).first;
+    interned.ptrs.insert(rtn);
+    return rtn;
+}
+
+const std::string* findInternedAttrName(const std::string& name) {
+    InternedAttrNames& interned = getInternedAttrNames();
+    if (interned.ptrs.count(&name))
+        return &name;
+
+    auto it = interned.names.find(name);
+    if (it == interned.names.end())
+        return NULL;
+    return &*it;
+}
+
+HiddenClass* HiddenClass::getOrMakeChild(const std::string* attr) {
+    for (const Child& c : children) {
+        if (c.first == attr)
+            return c.second;
+    }
 
     static StatCounter num_hclses("num_hidden_classes");
     num_hclses.log();
 
-    HiddenClass* rtn = new HiddenClass(this);
-    this->children[attr] = rtn;
-    rtn->attr_offsets[attr] = attr_offsets.size();
+    HiddenClass* rtn = new HiddenClass(this, attr);
+    children.push_back(Child(attr, rtn));
+    return rtn;
+}
+
+// Hidden classes with at most this many attributes get searched linearly:
+#define HCLS_LINEAR_LOOKUP_MAX 16
+
+int HiddenClass::getOffset(const std::string* attr) {
+    if (num_attrs <= HCLS_LINEAR_LOOKUP_MAX) {
+        for (HiddenClass* cur = this; cur->attr_name; cur = cur->parent) {
+            if (cur->attr_name == attr)
+                return cur->num_attrs - 1;
+        }
+        return -1;
+    }
+
+    ensureOffsetMap();
+    auto it = offset_map->offsets.find(attr);
+    // Entries past our own attributes belong to descendants further down the path:
+    if (it == offset_map->offsets.end() || it->second >= num_attrs)
+        return -1;
+    return it->second;
+}
+
+void HiddenClass::ensureOffsetMap() {
+    if (offset_map)
+        return;
+
+    // Find the closest ancestor that either has a table, or is small enough not to need one:
+    std::vector<HiddenClass*> path;
+    HiddenClass* cur = this;
+    while (!cur->offset_map && cur->num_attrs > HCLS_LINEAR_LOOKUP_MAX) {
+        path.push_back(cur);
+        cur = cur->parent;
+    }
+
+    OffsetMap* map = cur->offset_map;
+    if (!map || map->tip != cur) {
+        // The ancestor's table (if any) already continues down a different branch, so start a new one.
+        static StatCounter num_maps("num_hidden_class_offset_maps");
+        num_maps.log();
+
+        map = new OffsetMap();
+        for (HiddenClass* c = cur; c->attr_name; c = c->parent) {
+            map->offsets[c->attr_name] = c->num_attrs - 1;
+        }
+        map->tip = cur;
+    }
+
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        HiddenClass* h = *it;
+        map->offsets[h->attr_name] = h->num_attrs - 1;
+        map->tip = h;
+        h->offset_map = map;
+    }
+}
+
+std::vector<const std::string*> HiddenClass::getAttrNames() {
+    std::vector<const std::string*> rtn(num_attrs);
+    for (HiddenClass* cur = this; cur->attr_name; cur = cur->parent) {
+        rtn[cur->num_attrs - 1] = cur->attr_name;
+    }
     return rtn;
 }
 
@@ -428,27 +540,26 @@ HiddenClass* HiddenClass::delAttrToMakeHC(const std::string& attr) {
     int idx = getOffset(attr);
     assert(idx >= 0);
 
-    std::vector<std::string> new_attrs(attr_offsets.size() - 1);
-    for (auto it = attr_offsets.begin(); it != attr_offsets.end(); ++it) {
-        if (it->second < idx)
-            new_attrs[it->second] = it->first;
-        else if (it->second > idx) {
-            new_attrs[it->second - 1] = it->first;
-        }
+    // The attributes before the deleted one keep their offsets, so start from the ancestor
+    // hidden class that was just before the attribute got added, and re-add the ones after it.
+    std::vector<const std::string*> later_attrs;
+    HiddenClass* cur = this;
+    while (cur->num_attrs > idx + 1) {
+        later_attrs.push_back(cur->attr_name);
+        cur = cur->parent;
     }
+    assert(cur->attr_name == internAttrName(attr));
+    cur = cur->parent;
 
-    // TODO we can first locate the parent HiddenClass of the deleted
-    // attribute and hence avoid creation of its ancestors.
-    HiddenClass* cur = root_hcls;
-    for (const auto& attr : new_attrs) {
-        cur = cur->getOrMakeChild(attr);
+    for (auto it = later_attrs.rbegin(); it != later_attrs.rend(); ++it) {
+        cur = cur->getOrMakeChild(*it);
     }
     return cur;
 }
 
 Box::Box(BoxedClass* cls) : cls(cls) {
     // if (TRACK_ALLOCATIONS) {
-    // int id = Stats::getStatId("allocated_" + *getNameOfClass(c));
+    // int id = Stats::getStatId("allocated_" + std::string(getNameOfClass(c)));
     // Stats::log(id);
     //}
 
@@ -514,15 +625,21 @@ Box* Box::getattr(const std::string& attr, GetattrRewriteArgs* rewrite_args) {
     }
 
     if (rewrite_args) {
-        // TODO using the output register as the temporary makes register allocation easier
-        // since we don't need to clobber a register, but does it make the code slower?
-        RewriterVarUsage attrs = rewrite_args->obj.getAttr(cls->attrs_offset + HCATTRS_ATTRS_OFFSET,
-                                                           RewriterVarUsage::Kill, Location::any());
-        rewrite_args->out_rtn
-            = attrs.getAttr(offset * sizeof(Box*) + ATTRLIST_ATTRS_OFFSET, RewriterVarUsage::Kill, Location::any());
+        if (offset < hcls->num_inline) {
+            rewrite_args->out_rtn
+                = rewrite_args->obj.getAttr(cls->attrs_offset + HCATTRS_INLINE_ATTRS_OFFSET + offset * sizeof(Box*),
+                                            RewriterVarUsage::Kill, Location::any());
+        } else {
+            // TODO using the output register as the temporary makes register allocation easier
+            // since we don't need to clobber a register, but does it make the code slower?
+            RewriterVarUsage attrs = rewrite_args->obj.getAttr(cls->attrs_offset + HCATTRS_ATTRS_OFFSET,
+                                                               RewriterVarUsage::Kill, Location::any());
+            rewrite_args->out_rtn = attrs.getAttr((offset - hcls->num_inline) * sizeof(Box*) + ATTRLIST_ATTRS_OFFSET,
+                                                  RewriterVarUsage::Kill, Location::any());
+        }
     }
 
-    Box* rtn = attrs->attr_list->attrs[offset];
+    Box* rtn = *attrs->getSlot(offset);
     return rtn;
 }
 
@@ -570,10 +687,23 @@ void Box::setattr(const std::string& attr, Box* val, SetattrRewriteArgs* rewrite
 
     HCAttrs* attrs = getAttrsPtr();
     HiddenClass* hcls = attrs->hcls;
-    int numattrs = hcls->attr_offsets.size();
+    int numattrs = hcls->numAttrs();
 
     int offset = hcls->getOffset(attr);
 
+    if (cls == module_cls) {
+        // Jitted code might have embedded the previous value of this global (or of the builtin that it
+        // is about to shadow), so we have to invalidate that.  Stores that skip this check are only
+        // safe once nothing will embed this global anymore, which is the case after it's been rebound.
+        BoxedModule* self = static_cast<BoxedModule*>(this);
+        self->invalidateGlobal(attr, offset != -1);
+
+        if (self->canEmbedGlobal(attr))
+            rewrite_args = NULL;
+        else if (rewrite_args)
+            rewrite_args->obj.addGuard((intptr_t)this);
+    }
+
     if (rewrite_args) {
         rewrite_args->obj.addAttrGuard(cls->attrs_offset + HCATTRS_HCLS_OFFSET, (intptr_t)hcls);
 
@@ -584,16 +714,21 @@ void Box::setattr(const std::string& attr, Box* val, SetattrRewriteArgs* rewrite
 
     if (offset >= 0) {
         assert(offset < numattrs);
-        Box* prev = attrs->attr_list->attrs[offset];
-        attrs->attr_list->attrs[offset] = val;
+        *attrs->getSlot(offset) = val;
 
         if (rewrite_args) {
+            if (offset < hcls->num_inline) {
+                rewrite_args->obj.setAttr(cls->attrs_offset + HCATTRS_INLINE_ATTRS_OFFSET + offset * sizeof(Box*),
+                                          std::move(rewrite_args->attrval));
+                rewrite_args->obj.setDoneUsing();
+            } else {
+                RewriterVarUsage r_hattrs = rewrite_args->obj.getAttr(cls->attrs_offset + HCATTRS_ATTRS_OFFSET,
+                                                                      RewriterVarUsage::Kill, Location::any());
 
-            RewriterVarUsage r_hattrs = rewrite_args->obj.getAttr(cls->attrs_offset + HCATTRS_ATTRS_OFFSET,
-                                                                  RewriterVarUsage::Kill, Location::any());
-
-            r_hattrs.setAttr(offset * sizeof(Box*) + ATTRLIST_ATTRS_OFFSET, std::move(rewrite_args->attrval));
-            r_hattrs.setDoneUsing();
+                r_hattrs.setAttr((offset - hcls->num_inline) * sizeof(Box*) + ATTRLIST_ATTRS_OFFSET,
+                                 std::move(rewrite_args->attrval));
+                r_hattrs.setDoneUsing();
+            }
 
             rewrite_args->out_success = true;
         }
@@ -605,16 +740,41 @@ void Box::setattr(const std::string& attr, Box* val, SetattrRewriteArgs* rewrite
     HiddenClass* new_hcls = hcls->getOrMakeChild(attr);
 
     // TODO need to make sure we don't need to rearrange the attributes
-    assert(new_hcls->attr_offsets[attr] == numattrs);
+    assert(new_hcls->getOffset(attr) == numattrs);
 #ifndef NDEBUG
-    for (const auto& p : hcls->attr_offsets) {
-        assert(new_hcls->attr_offsets[p.first] == p.second);
+    std::vector<const std::string*> attr_names = hcls->getAttrNames();
+    for (int i = 0; i < numattrs; i++) {
+        assert(new_hcls->getOffset(attr_names[i]) == i);
     }
 #endif
 
+    // Size future instances of this class to hold this many attributes inline:
+    if (cls->canHaveInlineAttrs() && numattrs + 1 > cls->num_inline_attrs && numattrs + 1 <= MAX_INLINE_ATTRS)
+        cls->num_inline_attrs = numattrs + 1;
+
+    if (numattrs < hcls->num_inline) {
+        // There's still room inside the object, so there's nothing to allocate.
+        // Store the value before updating the hcls so that the collector never sees an uninitialized slot.
+        attrs->getInlineAttrs()[numattrs] = val;
+        attrs->hcls = new_hcls;
+
+        if (rewrite_args) {
+            rewrite_args->obj.setAttr(cls->attrs_offset + HCATTRS_INLINE_ATTRS_OFFSET + numattrs * sizeof(Box*),
+                                      std::move(rewrite_args->attrval));
+
+            RewriterVarUsage r_hcls = rewrite_args->rewriter->loadConst((intptr_t)new_hcls);
+            rewrite_args->obj.setAttr(cls->attrs_offset + HCATTRS_HCLS_OFFSET, std::move(r_hcls));
+            rewrite_args->obj.setDoneUsing();
+
+            rewrite_args->out_success = true;
+        }
+        return;
+    }
+
+    int num_outline = numattrs - hcls->num_inline;
     RewriterVarUsage r_new_array2(RewriterVarUsage::empty());
-    int new_size = sizeof(HCAttrs::AttrList) + sizeof(Box*) * (numattrs + 1);
-    if (numattrs == 0) {
+    int new_size = sizeof(HCAttrs::AttrList) + sizeof(Box*) * (num_outline + 1);
+    if (num_outline == 0) {
         attrs->attr_list = (HCAttrs::AttrList*)gc_alloc(new_size, gc::GCKind::UNTRACKED);
         if (rewrite_args) {
             RewriterVarUsage r_newsize = rewrite_args->rewriter->loadConst(new_size, Location::forArg(0));
@@ -639,7 +799,7 @@ void Box::setattr(const std::string& attr, Box* val, SetattrRewriteArgs* rewrite
     attrs->hcls = new_hcls;
 
     if (rewrite_args) {
-        r_new_array2.setAttr(numattrs * sizeof(Box*) + ATTRLIST_ATTRS_OFFSET, std::move(rewrite_args->attrval));
+        r_new_array2.setAttr(num_outline * sizeof(Box*) + ATTRLIST_ATTRS_OFFSET, std::move(rewrite_args->attrval));
         rewrite_args->obj.setAttr(cls->attrs_offset + HCATTRS_ATTRS_OFFSET, std::move(r_new_array2));
 
         RewriterVarUsage r_hcls = rewrite_args->rewriter->loadConst((intptr_t)new_hcls);
@@ -648,7 +808,7 @@ void Box::setattr(const std::string& attr, Box* val, SetattrRewriteArgs* rewrite
 
         rewrite_args->out_success = true;
     }
-    attrs->attr_list->attrs[numattrs] = val;
+    attrs->attr_list->attrs[num_outline] = val;
 }
 
 static Box* _handleClsAttr(Box* obj, Box* attr) {
@@ -743,7 +903,7 @@ Box* getclsattr_internal(Box* obj, const std::string& attr, GetattrRewriteArgs*
     return _handleClsAttr(obj, val);
 }
 
-extern "C" Box* getclsattr(Box* obj, const char* attr) {
+extern "C" Box* getclsattr(Box* obj, const std::string* attr) {
     static StatCounter slowpath_getclsattr("slowpath_getclsattr");
     slowpath_getclsattr.log();
 
@@ -755,7 +915,7 @@ extern "C" Box* getclsattr(Box* obj, const char* attr) {
     if (rewriter.get()) {
         //rewriter->trap();
         GetattrRewriteArgs rewrite_args(rewriter.get(), rewriter->getArg(0));
-        gotten = getclsattr_internal(obj, attr, &rewrite_args, NULL);
+        gotten = getclsattr_internal(obj, *attr, &rewrite_args, NULL);
 
         if (rewrite_args.out_success && gotten) {
             rewrite_args.out_rtn.move(-1);
@@ -768,7 +928,7 @@ extern "C" Box* getclsattr(Box* obj, const char* attr) {
     if (rewriter.get()) {
         // rewriter->trap();
         GetattrRewriteArgs rewrite_args(rewriter.get(), rewriter->getArg(0), rewriter->getReturnDestination(), false);
-        gotten = getclsattr_internal(obj, attr, &rewrite_args);
+        gotten = getclsattr_internal(obj, *attr, &rewrite_args);
 
         if (rewrite_args.out_success && gotten) {
             rewriter->commitReturning(std::move(rewrite_args.out_rtn));
@@ -776,9 +936,9 @@ extern "C" Box* getclsattr(Box* obj, const char* attr) {
 #endif
 }
 else {
-    gotten = getclsattr_internal(obj, attr, NULL);
+    gotten = getclsattr_internal(obj, *attr, NULL);
 }
-RELEASE_ASSERT(gotten, "%s:%s", getTypeName(obj)->c_str(), attr);
+RELEASE_ASSERT(gotten, "%s:%s", getTypeName(obj), attr->c_str());
 
 return gotten;
 }
@@ -794,7 +954,8 @@ Box* getattr_internal(Box* obj, const std::string& attr, bool check_cls, bool al
     if (allow_custom) {
         // Don't need to pass icentry args, since we special-case __getattribtue__ and __getattr__ to use
         // invalidation rather than guards
-        Box* getattribute = getclsattr_internal(obj, "__getattribute__", NULL);
+        static const std::string* getattribute_str = internAttrName("__getattribute__");
+        Box* getattribute = getclsattr_internal(obj, *getattribute_str, NULL);
         if (getattribute) {
             // TODO this is a good candidate for interning?
             Box* boxstr = boxString(attr);
@@ -876,7 +1037,8 @@ Box* getattr_internal(Box* obj, const std::string& attr, bool check_cls, bool al
     if (allow_custom) {
         // Don't need to pass icentry args, since we special-case __getattribtue__ and __getattr__ to use
         // invalidation rather than guards
-        Box* getattr = getclsattr_internal(obj, "__getattr__", NULL);
+        static const std::string* getattr_str = internAttrName("__getattr__");
+        Box* getattr = getclsattr_internal(obj, *getattr_str, NULL);
         if (getattr) {
             Box* boxstr = boxString(attr);
             Box* rtn = runtimeCall1(getattr, ArgPassSpec(1), boxstr);
@@ -915,13 +1077,13 @@ Box* getattr_internal(Box* obj, const std::string& attr, bool check_cls, bool al
     return rtn;
 }
 
-extern "C" Box* getattr(Box* obj, const char* attr) {
+extern "C" Box* getattr(Box* obj, const std::string* attr) {
     static StatCounter slowpath_getattr("slowpath_getattr");
     slowpath_getattr.log();
 
     if (VERBOSITY() >= 2) {
 #if !DISABLE_STATS
-        std::string per_name_stat_name = "getattr__" + std::string(attr);
+        std::string per_name_stat_name = "getattr__" + *attr;
         int id = Stats::getStatId(per_name_stat_name);
         Stats::log(id);
 #endif
@@ -940,7 +1102,7 @@ extern "C" Box* getattr(Box* obj, const char* attr) {
         else
             dest = rewriter->getReturnDestination();
         GetattrRewriteArgs rewrite_args(rewriter.get(), rewriter->getArg(0), dest, false);
-        val = getattr_internal(obj, attr, true, true, &rewrite_args);
+        val = getattr_internal(obj, *attr, true, true, &rewrite_args);
 
         if (rewrite_args.out_success && val) {
             if (recorder) {
@@ -955,30 +1117,30 @@ extern "C" Box* getattr(Box* obj, const char* attr) {
             }
         }
     } else {
-        val = getattr_internal(obj, attr, true, true, NULL);
+        val = getattr_internal(obj, *attr, true, true, NULL);
     }
 
     if (val) {
         return val;
     }
-    raiseAttributeError(obj, attr);
+    raiseAttributeError(obj, attr->c_str());
 }
 
-extern "C" void setattr(Box* obj, const char* attr, Box* attr_val) {
-    assert(strcmp(attr, "__class__") != 0);
+extern "C" void setattr(Box* obj, const std::string* attr, Box* attr_val) {
+    assert(*attr != "__class__");
 
     static StatCounter slowpath_setattr("slowpath_setattr");
     slowpath_setattr.log();
 
     if (!obj->cls->instancesHaveAttrs()) {
-        raiseAttributeError(obj, attr);
+        raiseAttributeError(obj, attr->c_str());
     }
 
     if (obj->cls == type_cls) {
         BoxedClass* cobj = static_cast<BoxedClass*>(obj);
         if (!isUserDefined(cobj)) {
             raiseExcHelper(TypeError, "can't set attributes of built-in/extension type '%s'",
-                           getNameOfClass(cobj)->c_str());
+                           getNameOfClass(cobj));
         }
     }
 
@@ -988,7 +1150,7 @@ extern "C" void setattr(Box* obj, const char* attr, Box* attr_val) {
     if (rewriter.get()) {
         // rewriter->trap();
         SetattrRewriteArgs rewrite_args(rewriter.get(), rewriter->getArg(0), rewriter->getArg(2), false);
-        obj->setattr(attr, attr_val, &rewrite_args);
+        obj->setattr(*attr, attr_val, &rewrite_args);
         if (rewrite_args.out_success) {
             rewriter->commit();
         } else {
@@ -996,7 +1158,7 @@ extern "C" void setattr(Box* obj, const char* attr, Box* attr_val) {
             rewrite_args.attrval.setDoneUsing();
         }
     } else {
-        obj->setattr(attr, attr_val, NULL);
+        obj->setattr(*attr, attr_val, NULL);
     }
 }
 
@@ -1065,12 +1227,13 @@ extern "C" bool nonzero(Box* obj) {
     // TODO move internal callers to nonzeroInternal, and log *all* calls to nonzero
     slowpath_nonzero.log();
 
-    // int id = Stats::getStatId("slowpath_nonzero_" + *getTypeName(obj));
+    // int id = Stats::getStatId("slowpath_nonzero_" + std::string(getTypeName(obj)));
     // Stats::log(id);
 
-    Box* func = getclsattr_internal(obj, "__nonzero__", NULL);
+    static const std::string* nonzero_str = internAttrName("__nonzero__");
+    Box* func = getclsattr_internal(obj, *nonzero_str, NULL);
     if (func == NULL) {
-        RELEASE_ASSERT(isUserDefined(obj->cls), "%s.__nonzero__", getTypeName(obj)->c_str()); // TODO
+        RELEASE_ASSERT(isUserDefined(obj->cls), "%s.__nonzero__", getTypeName(obj)); // TODO
         return true;
     }
 
@@ -1084,7 +1247,7 @@ extern "C" bool nonzero(Box* obj) {
         bool rtn = b->n != 0;
         return rtn;
     } else {
-        raiseExcHelper(TypeError, "__nonzero__ should return bool or int, returned %s", getTypeName(r)->c_str());
+        raiseExcHelper(TypeError, "__nonzero__ should return bool or int, returned %s", getTypeName(r));
     }
 }
 
@@ -1099,7 +1262,7 @@ extern "C" BoxedString* str(Box* obj) {
 
         if (str == NULL) {
             char buf[80];
-            snprintf(buf, 80, "<%s object at %p>", getTypeName(obj)->c_str(), obj);
+            snprintf(buf, 80, "<%s object at %p>", getTypeName(obj), obj);
             return boxStrConstant(buf);
         } else {
             obj = runtimeCallInternal0(str, NULL, ArgPassSpec(0));
@@ -1118,13 +1281,13 @@ extern "C" Box* repr(Box* obj) {
 
     Box* repr = getclsattr_internal(obj, "__repr__", NULL);
     if (repr == NULL) {
-        ASSERT(isUserDefined(obj->cls), "%s", getTypeName(obj)->c_str());
+        ASSERT(isUserDefined(obj->cls), "%s", getTypeName(obj));
 
         char buf[80];
         if (obj->cls == type_cls) {
-            snprintf(buf, 80, "<type '%s'>", getNameOfClass(static_cast<BoxedClass*>(obj))->c_str());
+            snprintf(buf, 80, "<type '%s'>", getNameOfClass(static_cast<BoxedClass*>(obj)));
         } else {
-            snprintf(buf, 80, "<%s object at %p>", getTypeName(obj)->c_str(), obj);
+            snprintf(buf, 80, "<%s object at %p>", getTypeName(obj), obj);
         }
         return boxStrConstant(buf);
     } else {
@@ -1178,7 +1341,7 @@ extern "C" BoxedInt* hash(Box* obj) {
 
     Box* hash = getclsattr_internal(obj, "__hash__", NULL);
     if (hash == NULL) {
-        ASSERT(isUserDefined(obj->cls), "%s.__hash__", getTypeName(obj)->c_str());
+        ASSERT(isUserDefined(obj->cls), "%s.__hash__", getTypeName(obj));
         // TODO not the best way to handle this...
         return static_cast<BoxedInt*>(boxInt((i64)obj));
     }
@@ -1206,7 +1369,7 @@ extern "C" BoxedInt* lenInternal(Box* obj, LenRewriteArgs* rewrite_args) {
     }
 
     if (rtn == NULL) {
-        raiseExcHelper(TypeError, "object of type '%s' has no len()", getTypeName(obj)->c_str());
+        raiseExcHelper(TypeError, "object of type '%s' has no len()", getTypeName(obj));
     }
 
     if (rtn->cls != int_cls) {
@@ -1264,7 +1427,7 @@ extern "C" void print(Box* obj) {
     slowpath_print.log();
 
     BoxedString* strd = str(obj);
-    printf("%s", strd->s.c_str());
+    printf("%s", strd->c_str());
 }
 
 extern "C" void dump(void* p) {
@@ -1289,9 +1452,9 @@ extern "C" void dump(void* p) {
     if (al->kind_id == gc::GCKind::PYTHON) {
         printf("Python object\n");
         Box* b = (Box*)p;
-        printf("Class: %s\n", getTypeName(b)->c_str());
+        printf("Class: %s\n", getTypeName(b));
         if (isSubclass(b->cls, type_cls)) {
-            printf("Type name: %s\n", getNameOfClass(static_cast<BoxedClass*>(b))->c_str());
+            printf("Type name: %s\n", getNameOfClass(static_cast<BoxedClass*>(b)));
         }
         return;
     }
@@ -1386,7 +1549,7 @@ extern "C" Box* callattrInternal(Box* obj, const std::string* attr, LookupScope
             }
 
             if (!rtn) {
-                raiseExcHelper(TypeError, "'%s' object is not callable", getTypeName(inst_attr)->c_str());
+                raiseExcHelper(TypeError, "'%s' object is not callable", getTypeName(inst_attr));
             }
 
             r_instattr.ensureDoneUsing();
@@ -1599,7 +1762,7 @@ extern "C" Box* callattrInternal(Box* obj, const std::string* attr, LookupScope
         }
 
         if (!rtn) {
-            raiseExcHelper(TypeError, "'%s' object is not callable", getTypeName(clsattr)->c_str());
+            raiseExcHelper(TypeError, "'%s' object is not callable", getTypeName(clsattr));
         }
 
         if (rewrite_args)
@@ -1724,44 +1887,53 @@ static CompiledFunction* pickVersion(CLFunction* f, int num_output_args, Box* oa
     return chosen_cf;
 }
 
-static void placeKeyword(const std::vector<AST_expr*>& arg_names, std::vector<bool>& params_filled,
-                         const std::string& kw_name, Box* kw_val, Box*& oarg1, Box*& oarg2, Box*& oarg3, Box** oargs,
-                         BoxedDict* okwargs) {
+// Puts a keyword argument into the parameter slot of the same name, or into the
+// **kwargs dict if there is no such parameter.  Returns the index of the parameter
+// that got filled, or -1 if the value went into the kwargs dict.
+static int placeKeyword(const std::vector<const std::string*>& param_names, bool* params_filled,
+                        const std::string& kw_name, Box* kw_val, Box*& oarg1, Box*& oarg2, Box*& oarg3, Box** oargs,
+                        BoxedDict* okwargs) {
     assert(kw_val);
 
-    bool found = false;
-    for (int j = 0; j < arg_names.size(); j++) {
-        AST_expr* e = arg_names[j];
-        if (e->type != AST_TYPE::Name)
-            continue;
-
-        AST_Name* n = ast_cast<AST_Name>(e);
-        if (n->id == kw_name) {
-            if (params_filled[j]) {
-                raiseExcHelper(TypeError, "<function>() got multiple values for keyword argument '%s'",
-                               kw_name.c_str());
+    // Keyword names coming from jitted code are interned, as are the parameter names,
+    // so try matching by pointer first before falling back to comparing the strings:
+    int found = -1;
+    for (int j = 0; j < param_names.size(); j++) {
+        if (param_names[j] == &kw_name) {
+            found = j;
+            break;
+        }
+    }
+    if (found == -1) {
+        for (int j = 0; j < param_names.size(); j++) {
+            if (param_names[j] && *param_names[j] == kw_name) {
+                found = j;
+                break;
             }
+        }
+    }
 
-            getArg(j, oarg1, oarg2, oarg3, oargs) = kw_val;
-            params_filled[j] = true;
-
-            found = true;
-            break;
+    if (found != -1) {
+        if (params_filled[found]) {
+            raiseExcHelper(TypeError, "<function>() got multiple values for keyword argument '%s'", kw_name.c_str());
         }
+
+        getArg(found, oarg1, oarg2, oarg3, oargs) = kw_val;
+        params_filled[found] = true;
+
+        return found;
     }
 
-    if (!found) {
-        if (okwargs) {
-            Box*& v = okwargs->d[boxString(kw_name)];
-            if (v) {
-                raiseExcHelper(TypeError, "<function>() got multiple values for keyword argument '%s'",
-                               kw_name.c_str());
-            }
-            v = kw_val;
-        } else {
-            raiseExcHelper(TypeError, "<function>() got an unexpected keyword argument '%s'", kw_name.c_str());
+    if (okwargs) {
+        Box*& v = okwargs->d[boxString(kw_name)];
+        if (v) {
+            raiseExcHelper(TypeError, "<function>() got multiple values for keyword argument '%s'", kw_name.c_str());
         }
+        v = kw_val;
+    } else {
+        raiseExcHelper(TypeError, "<function>() got an unexpected keyword argument '%s'", kw_name.c_str());
     }
+    return -1;
 }
 
 Box* callFunc(BoxedFunction* func, CallRewriteArgs* rewrite_args, ArgPassSpec argspec, Box* arg1, Box* arg2, Box* arg3,
@@ -1790,8 +1962,10 @@ Box* callFunc(BoxedFunction* func, CallRewriteArgs* rewrite_args, ArgPassSpec ar
         rewrite_args = NULL;
     }
 
-    // These could be handled:
-    if (argspec.num_keywords) {
+    // Keywords get mapped to parameter slots by name, which we can only do for functions
+    // that we have the source (and thus the parameter names) for.
+    // TODO could handle *args as well; it just needs to get placed after the keywords are.
+    if (argspec.num_keywords && (!f->source || f->takes_varargs)) {
         rewrite_args = NULL;
     }
 
@@ -1829,7 +2003,9 @@ Box* callFunc(BoxedFunction* func, CallRewriteArgs* rewrite_args, ArgPassSpec ar
     if (rewrite_args) {
         // We might have trouble if we have more output args than input args,
         // such as if we need more space to pass defaults.
-        if (num_output_args > 3 && num_output_args > argspec.totalPassed()) {
+        // If there are keywords, the args get rearranged into a new array once we know
+        // where each keyword goes; see below.
+        if (num_output_args > 3 && num_output_args > argspec.totalPassed() && !argspec.num_keywords) {
             int arg_bytes_required = (num_output_args - 3) * sizeof(Box*);
             RewriterVarUsage new_args(RewriterVarUsage::empty());
             if (rewrite_args->args.isDoneUsing()) {
@@ -1880,7 +2056,8 @@ Box* callFunc(BoxedFunction* func, CallRewriteArgs* rewrite_args, ArgPassSpec ar
         getArg(i + positional_to_positional, oarg1, oarg2, oarg3, oargs) = varargs[i];
     }
 
-    std::vector<bool> params_filled(num_output_args, false);
+    bool* params_filled = (bool*)alloca(num_output_args * sizeof(bool));
+    memset(params_filled, 0, num_output_args * sizeof(bool));
     for (int i = 0; i < positional_to_positional + varargs_to_positional; i++) {
         params_filled[i] = true;
     }
@@ -1929,7 +2106,8 @@ Box* callFunc(BoxedFunction* func, CallRewriteArgs* rewrite_args, ArgPassSpec ar
         getArg(f->num_args + (f->takes_varargs ? 1 : 0), oarg1, oarg2, oarg3, oargs) = okwargs;
     }
 
-    const std::vector<AST_expr*>* arg_names = f->source ? f->source->arg_names.args : NULL;
+    const std::vector<const std::string*>* arg_names
+        = (f->source && f->source->arg_names.args) ? &f->source->arg_names.interned_args : NULL;
     if (arg_names == nullptr && argspec.num_keywords && !f->takes_kwargs) {
         raiseExcHelper(TypeError, "<function @%p>() doesn't take keyword arguments", f->versions[0]->code);
     }
@@ -1937,9 +2115,12 @@ Box* callFunc(BoxedFunction* func, CallRewriteArgs* rewrite_args, ArgPassSpec ar
     if (argspec.num_keywords)
         assert(argspec.num_keywords == keyword_names->size());
 
-    for (int i = 0; i < argspec.num_keywords; i++) {
-        assert(!rewrite_args && "would need to be handled here");
+    // For each keyword, which parameter it ended up in:
+    int* keyword_dests = NULL;
+    if (rewrite_args && argspec.num_keywords)
+        keyword_dests = (int*)alloca(argspec.num_keywords * sizeof(int));
 
+    for (int i = 0; i < argspec.num_keywords; i++) {
         int arg_idx = i + argspec.num_args;
         Box* kw_val = getArg(arg_idx, arg1, arg2, arg3, args);
 
@@ -1951,7 +2132,46 @@ Box* callFunc(BoxedFunction* func, CallRewriteArgs* rewrite_args, ArgPassSpec ar
 
         assert(arg_names);
 
-        placeKeyword(*arg_names, params_filled, *(*keyword_names)[i], kw_val, oarg1, oarg2, oarg3, oargs, okwargs);
+        int dest = placeKeyword(*arg_names, params_filled, *(*keyword_names)[i], kw_val, oarg1, oarg2, oarg3, oargs,
+                                okwargs);
+        if (keyword_dests) {
+            assert(dest != -1);
+            keyword_dests[i] = dest;
+        }
+    }
+
+    if (rewrite_args && argspec.num_keywords) {
+        // The keyword names are constant for this callsite, and we've guarded on the function,
+        // so the mapping from keywords to parameters we just computed holds for every call that
+        // goes through this IC.  Emit the corresponding moves:
+        std::vector<RewriterVarUsage> passed;
+        for (int i = 0; i < num_passed_args; i++) {
+            if (i == 0)
+                passed.push_back(std::move(rewrite_args->arg1));
+            else if (i == 1)
+                passed.push_back(std::move(rewrite_args->arg2));
+            else if (i == 2)
+                passed.push_back(std::move(rewrite_args->arg3));
+            else
+                passed.push_back(rewrite_args->args.getAttr((i - 3) * sizeof(Box*), RewriterVarUsage::KillFlag::NoKill,
+                                                            Location::any()));
+        }
+        rewrite_args->args.ensureDoneUsing();
+
+        if (num_output_args > 3)
+            rewrite_args->args = rewrite_args->rewriter->allocate(num_output_args - 3);
+
+        for (int i = 0; i < num_passed_args; i++) {
+            int dest = (i < argspec.num_args) ? i : keyword_dests[i - argspec.num_args];
+            if (dest == 0)
+                rewrite_args->arg1 = std::move(passed[i]);
+            else if (dest == 1)
+                rewrite_args->arg2 = std::move(passed[i]);
+            else if (dest == 2)
+                rewrite_args->arg3 = std::move(passed[i]);
+            else
+                rewrite_args->args.setAttr((dest - 3) * sizeof(Box*), std::move(passed[i]));
+        }
     }
 
     if (argspec.has_kwargs) {
@@ -1969,14 +2189,14 @@ Box* callFunc(BoxedFunction* func, CallRewriteArgs* rewrite_args, ArgPassSpec ar
             BoxedString* s = static_cast<BoxedString*>(p.first);
 
             if (arg_names) {
-                placeKeyword(*arg_names, params_filled, s->s, p.second, oarg1, oarg2, oarg3, oargs, okwargs);
+                placeKeyword(*arg_names, params_filled, s->s.str(), p.second, oarg1, oarg2, oarg3, oargs, okwargs);
             } else {
                 assert(okwargs);
 
                 Box*& v = okwargs->d[p.first];
                 if (v) {
                     raiseExcHelper(TypeError, "<function>() got multiple values for keyword argument '%s'",
-                                   s->s.c_str());
+                                   s->c_str());
                 }
                 v = p.second;
             }
@@ -2118,7 +2338,7 @@ Box* runtimeCallInternal(Box* obj, CallRewriteArgs* rewrite_args, ArgPassSpec ar
             rtn = callattrInternal(obj, &_call_str, CLASS_ONLY, NULL, argspec, arg1, arg2, arg3, args, keyword_names);
         }
         if (!rtn)
-            raiseExcHelper(TypeError, "'%s' object is not callable", getTypeName(obj)->c_str());
+            raiseExcHelper(TypeError, "'%s' object is not callable", getTypeName(obj));
         return rtn;
     }
 
@@ -2158,8 +2378,7 @@ Box* runtimeCallInternal(Box* obj, CallRewriteArgs* rewrite_args, ArgPassSpec ar
         Box* res = callable(f, rewrite_args, argspec, arg1, arg2, arg3, args, keyword_names);
         return res;
     } else if (obj->cls == instancemethod_cls) {
-        // TODO it's dumb but I should implement patchpoints here as well
-        // duplicated with callattr
+        // TODO duplicated with callattr
         BoxedInstanceMethod* im = static_cast<BoxedInstanceMethod*>(obj);
 
         if (rewrite_args && !rewrite_args->func_guarded) {
@@ -2206,9 +2425,41 @@ Box* runtimeCallInternal(Box* obj, CallRewriteArgs* rewrite_args, ArgPassSpec ar
             Box** new_args = (Box**)alloca(sizeof(Box*) * (npassed_args + 1 - 3));
             new_args[0] = arg3;
             memcpy(new_args + 1, args, (npassed_args - 3) * sizeof(Box*));
-            Box* rtn = runtimeCall(im->func, ArgPassSpec(argspec.num_args + 1, argspec.num_keywords,
-                                                         argspec.has_starargs, argspec.has_kwargs),
-                                   im->obj, arg1, arg2, new_args, keyword_names);
+
+            Box* rtn;
+            if (rewrite_args) {
+                // Same shuffling as in callattrInternal: the bound object becomes the first argument,
+                // and everything else gets shifted over by one.
+                CallRewriteArgs srewrite_args(rewrite_args->rewriter, rewrite_args->obj.addUse(),
+                                              rewrite_args->destination, rewrite_args->more_guards_after);
+
+                srewrite_args.arg1 = rewrite_args->obj.getAttr(INSTANCEMETHOD_OBJ_OFFSET,
+                                                               RewriterVarUsage::KillFlag::Kill, Location::any());
+                srewrite_args.arg2 = std::move(rewrite_args->arg1);
+                srewrite_args.arg3 = std::move(rewrite_args->arg2);
+                srewrite_args.args = rewrite_args->rewriter->allocateAndCopyPlus1(
+                    std::move(rewrite_args->arg3),
+                    npassed_args == 3 ? RewriterVarUsage::empty() : std::move(rewrite_args->args), npassed_args - 3);
+                srewrite_args.func_guarded = true;
+                srewrite_args.args_guarded = true;
+
+                rtn = runtimeCallInternal(
+                    im->func, &srewrite_args,
+                    ArgPassSpec(argspec.num_args + 1, argspec.num_keywords, argspec.has_starargs, argspec.has_kwargs),
+                    im->obj, arg1, arg2, new_args, keyword_names);
+
+                if (!srewrite_args.out_success) {
+                    rewrite_args = NULL;
+                } else {
+                    rewrite_args->out_rtn = std::move(srewrite_args.out_rtn);
+                }
+            } else {
+                rtn = runtimeCallInternal(im->func, NULL, ArgPassSpec(argspec.num_args + 1, argspec.num_keywords,
+                                                                      argspec.has_starargs, argspec.has_kwargs),
+                                          im->obj, arg1, arg2, new_args, keyword_names);
+            }
+            if (rewrite_args)
+                rewrite_args->out_success = true;
             return rtn;
         }
     }
@@ -2319,9 +2570,10 @@ extern "C" Box* binopInternal(Box* lhs, Box* rhs, int op_type, bool inplace, Bin
     const std::string& op_name = getOpName(op_type);
     Box* lrtn;
     if (rewrite_args) {
-        CallRewriteArgs srewrite_args(rewrite_args->rewriter, std::move(rewrite_args->lhs), rewrite_args->destination,
+        CallRewriteArgs srewrite_args(rewrite_args->rewriter, rewrite_args->lhs.addUse(), rewrite_args->destination,
                                       rewrite_args->more_guards_after);
-        srewrite_args.arg1 = std::move(rewrite_args->rhs);
+        srewrite_args.arg1 = rewrite_args->rhs.addUse();
+        srewrite_args.args_guarded = true;
         lrtn = callattrInternal1(lhs, &op_name, CLASS_ONLY, &srewrite_args, ArgPassSpec(1), rhs);
 
         if (!srewrite_args.out_success)
@@ -2340,20 +2592,44 @@ extern "C" Box* binopInternal(Box* lhs, Box* rhs, int op_type, bool inplace, Bin
     if (lrtn) {
         if (lrtn != NotImplemented) {
             if (rewrite_args) {
+                rewrite_args->lhs.setDoneUsing();
+                rewrite_args->rhs.setDoneUsing();
                 rewrite_args->out_success = true;
             }
             return lrtn;
         }
+
+        // TODO patch this case; whether the lhs returns NotImplemented can depend on more than
+        // just the classes of the arguments.
+        if (rewrite_args) {
+            assert(rewrite_args->out_success == false);
+            rewrite_args = NULL;
+        }
     }
 
-    // TODO patch these cases
+    // If we get here with rewrite_args still set, the lhs class doesn't define the operator at all,
+    // which is something we've guarded on, so we can patch in the call to the reverse operator.
+    std::string rop_name = getReverseOpName(op_type);
+    Box* rrtn;
     if (rewrite_args) {
-        assert(rewrite_args->out_success == false);
-        rewrite_args = NULL;
+        CallRewriteArgs srewrite_args(rewrite_args->rewriter, std::move(rewrite_args->rhs), rewrite_args->destination,
+                                      rewrite_args->more_guards_after);
+        srewrite_args.arg1 = std::move(rewrite_args->lhs);
+        srewrite_args.args_guarded = true;
+        rrtn = callattrInternal1(rhs, &rop_name, CLASS_ONLY, &srewrite_args, ArgPassSpec(1), lhs);
+
+        if (!srewrite_args.out_success) {
+            rewrite_args = NULL;
+        } else if (rrtn && rrtn != NotImplemented) {
+            rewrite_args->out_rtn = std::move(srewrite_args.out_rtn);
+            rewrite_args->out_success = true;
+        } else {
+            srewrite_args.out_rtn.ensureDoneUsing();
+        }
+    } else {
+        rrtn = callattrInternal1(rhs, &rop_name, CLASS_ONLY, NULL, ArgPassSpec(1), lhs);
     }
 
-    std::string rop_name = getReverseOpName(op_type);
-    Box* rrtn = callattrInternal1(rhs, &rop_name, CLASS_ONLY, NULL, ArgPassSpec(1), lhs);
     if (rrtn != NULL && rrtn != NotImplemented)
         return rrtn;
 
@@ -2368,24 +2644,24 @@ extern "C" Box* binopInternal(Box* lhs, Box* rhs, int op_type, bool inplace, Bin
         if (inplace) {
             std::string iop_name = getInplaceOpName(op_type);
             if (irtn)
-                fprintf(stderr, "%s has %s, but returned NotImplemented\n", getTypeName(lhs)->c_str(),
+                fprintf(stderr, "%s has %s, but returned NotImplemented\n", getTypeName(lhs),
                         iop_name.c_str());
             else
-                fprintf(stderr, "%s does not have %s\n", getTypeName(lhs)->c_str(), iop_name.c_str());
+                fprintf(stderr, "%s does not have %s\n", getTypeName(lhs), iop_name.c_str());
         }
 
         if (lrtn)
-            fprintf(stderr, "%s has %s, but returned NotImplemented\n", getTypeName(lhs)->c_str(), op_name.c_str());
+            fprintf(stderr, "%s has %s, but returned NotImplemented\n", getTypeName(lhs), op_name.c_str());
         else
-            fprintf(stderr, "%s does not have %s\n", getTypeName(lhs)->c_str(), op_name.c_str());
+            fprintf(stderr, "%s does not have %s\n", getTypeName(lhs), op_name.c_str());
         if (rrtn)
-            fprintf(stderr, "%s has %s, but returned NotImplemented\n", getTypeName(rhs)->c_str(), rop_name.c_str());
+            fprintf(stderr, "%s has %s, but returned NotImplemented\n", getTypeName(rhs), rop_name.c_str());
         else
-            fprintf(stderr, "%s does not have %s\n", getTypeName(rhs)->c_str(), rop_name.c_str());
+            fprintf(stderr, "%s does not have %s\n", getTypeName(rhs), rop_name.c_str());
     }
 
     raiseExcHelper(TypeError, "unsupported operand type(s) for %s%s: '%s' and '%s'", op_sym.data(), op_sym_suffix,
-                   getTypeName(lhs)->c_str(), getTypeName(rhs)->c_str());
+                   getTypeName(lhs), getTypeName(rhs));
 }
 
 extern "C" Box* binop(Box* lhs, Box* rhs, int op_type) {
@@ -2393,7 +2669,7 @@ extern "C" Box* binop(Box* lhs, Box* rhs, int op_type) {
     slowpath_binop.log();
     // static StatCounter nopatch_binop("nopatch_binop");
 
-    // int id = Stats::getStatId("slowpath_binop_" + *getTypeName(lhs) + op_name + *getTypeName(rhs));
+    // int id = Stats::getStatId("slowpath_binop_" + std::string(getTypeName(lhs)) + op_name + std::string(getTypeName(rhs)));
     // Stats::log(id);
 
     std::unique_ptr<Rewriter> rewriter((Rewriter*)NULL);
@@ -2430,7 +2706,7 @@ extern "C" Box* augbinop(Box* lhs, Box* rhs, int op_type) {
     slowpath_binop.log();
     // static StatCounter nopatch_binop("nopatch_binop");
 
-    // int id = Stats::getStatId("slowpath_binop_" + *getTypeName(lhs) + op_name + *getTypeName(rhs));
+    // int id = Stats::getStatId("slowpath_binop_" + std::string(getTypeName(lhs)) + op_name + std::string(getTypeName(rhs)));
     // Stats::log(id);
 
     std::unique_ptr<Rewriter> rewriter((Rewriter*)NULL);
@@ -2486,15 +2762,15 @@ Box* compareInternal(Box* lhs, Box* rhs, int op_type, CompareRewriteArgs* rewrit
             static const std::string str_iter("__iter__");
             Box* iter = callattrInternal0(rhs, &str_iter, CLASS_ONLY, NULL, ArgPassSpec(0));
             if (iter)
-                ASSERT(isUserDefined(rhs->cls), "%s should probably have a __contains__", getTypeName(rhs)->c_str());
+                ASSERT(isUserDefined(rhs->cls), "%s should probably have a __contains__", getTypeName(rhs));
             RELEASE_ASSERT(iter == NULL, "need to try iterating");
 
             Box* getitem = typeLookup(rhs->cls, "__getitem__", NULL);
             if (getitem)
-                ASSERT(isUserDefined(rhs->cls), "%s should probably have a __contains__", getTypeName(rhs)->c_str());
+                ASSERT(isUserDefined(rhs->cls), "%s should probably have a __contains__", getTypeName(rhs));
             RELEASE_ASSERT(getitem == NULL, "need to try old iteration protocol");
 
-            raiseExcHelper(TypeError, "argument of type '%s' is not iterable", getTypeName(rhs)->c_str());
+            raiseExcHelper(TypeError, "argument of type '%s' is not iterable", getTypeName(rhs));
         }
 
         bool b = nonzero(contained);
@@ -2517,11 +2793,14 @@ Box* compareInternal(Box* lhs, Box* rhs, int op_type, CompareRewriteArgs* rewrit
 
     const std::string& op_name = getOpName(op_type);
 
+    bool can_patchpoint = !isUserDefined(lhs->cls) && !isUserDefined(rhs->cls);
+
     Box* lrtn;
     if (rewrite_args) {
-        CallRewriteArgs crewrite_args(rewrite_args->rewriter, std::move(rewrite_args->lhs), rewrite_args->destination,
+        CallRewriteArgs crewrite_args(rewrite_args->rewriter, rewrite_args->lhs.addUse(), rewrite_args->destination,
                                       rewrite_args->more_guards_after);
-        crewrite_args.arg1 = std::move(rewrite_args->rhs);
+        crewrite_args.arg1 = rewrite_args->rhs.addUse();
+        crewrite_args.args_guarded = true;
         lrtn = callattrInternal1(lhs, &op_name, CLASS_ONLY, &crewrite_args, ArgPassSpec(1), rhs);
 
         if (!crewrite_args.out_success)
@@ -2534,9 +2813,10 @@ Box* compareInternal(Box* lhs, Box* rhs, int op_type, CompareRewriteArgs* rewrit
 
     if (lrtn) {
         if (lrtn != NotImplemented) {
-            bool can_patchpoint = !isUserDefined(lhs->cls) && !isUserDefined(rhs->cls);
             if (rewrite_args) {
                 if (can_patchpoint) {
+                    rewrite_args->lhs.setDoneUsing();
+                    rewrite_args->rhs.setDoneUsing();
                     rewrite_args->out_success = true;
                 } else {
                     rewrite_args->out_rtn.ensureDoneUsing();
@@ -2544,17 +2824,38 @@ Box* compareInternal(Box* lhs, Box* rhs, int op_type, CompareRewriteArgs* rewrit
             }
             return lrtn;
         }
-    }
 
-    // TODO patch these cases
-    if (rewrite_args) {
-        rewrite_args->out_rtn.ensureDoneUsing();
-        assert(rewrite_args->out_success == false);
-        rewrite_args = NULL;
+        // TODO patch this case
+        if (rewrite_args) {
+            rewrite_args->out_rtn.ensureDoneUsing();
+            assert(rewrite_args->out_success == false);
+            rewrite_args = NULL;
+        }
     }
 
+    // The lhs class doesn't define the comparison at all; like in binopInternal, that's guarded on,
+    // so we can patch in the call to the reflected comparison.
     std::string rop_name = getReverseOpName(op_type);
-    Box* rrtn = callattrInternal1(rhs, &rop_name, CLASS_ONLY, NULL, ArgPassSpec(1), lhs);
+    Box* rrtn;
+    if (rewrite_args && can_patchpoint) {
+        CallRewriteArgs crewrite_args(rewrite_args->rewriter, std::move(rewrite_args->rhs), rewrite_args->destination,
+                                      rewrite_args->more_guards_after);
+        crewrite_args.arg1 = std::move(rewrite_args->lhs);
+        crewrite_args.args_guarded = true;
+        rrtn = callattrInternal1(rhs, &rop_name, CLASS_ONLY, &crewrite_args, ArgPassSpec(1), lhs);
+
+        if (!crewrite_args.out_success) {
+            rewrite_args = NULL;
+        } else if (rrtn && rrtn != NotImplemented) {
+            rewrite_args->out_rtn = std::move(crewrite_args.out_rtn);
+            rewrite_args->out_success = true;
+        } else {
+            crewrite_args.out_rtn.ensureDoneUsing();
+        }
+    } else {
+        rrtn = callattrInternal1(rhs, &rop_name, CLASS_ONLY, NULL, ArgPassSpec(1), lhs);
+    }
+
     if (rrtn != NULL && rrtn != NotImplemented)
         return rrtn;
 
@@ -2632,7 +2933,7 @@ extern "C" Box* unaryop(Box* operand, int op_type) {
 
     Box* attr_func = getclsattr_internal(operand, op_name, NULL);
 
-    ASSERT(attr_func, "%s.%s", getTypeName(operand)->c_str(), op_name.c_str());
+    ASSERT(attr_func, "%s.%s", getTypeName(operand), op_name.c_str());
 
     Box* rtn = runtimeCall0(attr_func, ArgPassSpec(0));
     return rtn;
@@ -2670,14 +2971,14 @@ extern "C" Box* getitem(Box* value, Box* slice) {
     if (rtn == NULL) {
         // different versions of python give different error messages for this:
         if (PYTHON_VERSION_MAJOR == 2 && PYTHON_VERSION_MINOR < 7) {
-            raiseExcHelper(TypeError, "'%s' object is unsubscriptable", getTypeName(value)->c_str()); // tested on 2.6.6
+            raiseExcHelper(TypeError, "'%s' object is unsubscriptable", getTypeName(value)); // tested on 2.6.6
         } else if (PYTHON_VERSION_MAJOR == 2 && PYTHON_VERSION_MINOR == 7 && PYTHON_VERSION_MICRO < 3) {
             raiseExcHelper(TypeError, "'%s' object is not subscriptable",
-                           getTypeName(value)->c_str()); // tested on 2.7.1
+                           getTypeName(value)); // tested on 2.7.1
         } else {
             // Changed to this in 2.7.3:
             raiseExcHelper(TypeError, "'%s' object has no attribute '__getitem__'",
-                           getTypeName(value)->c_str()); // tested on 2.7.3
+                           getTypeName(value)); // tested on 2.7.3
         }
     }
 
@@ -2712,7 +3013,7 @@ extern "C" void setitem(Box* target, Box* slice, Box* value) {
     }
 
     if (rtn == NULL) {
-        raiseExcHelper(TypeError, "'%s' object does not support item assignment", getTypeName(target)->c_str());
+        raiseExcHelper(TypeError, "'%s' object does not support item assignment", getTypeName(target));
     }
 
     if (rewriter.get()) {
@@ -2748,7 +3049,7 @@ extern "C" void delitem(Box* target, Box* slice) {
     }
 
     if (rtn == NULL) {
-        raiseExcHelper(TypeError, "'%s' object does not support item deletion", getTypeName(target)->c_str());
+        raiseExcHelper(TypeError, "'%s' object does not support item deletion", getTypeName(target));
     }
 
     if (rewriter.get()) {
@@ -2757,6 +3058,9 @@ extern "C" void delitem(Box* target, Box* slice) {
 }
 
 void Box::delattr(const std::string& attr, DelattrRewriteArgs* rewrite_args) {
+    if (cls == module_cls)
+        static_cast<BoxedModule*>(this)->invalidateGlobal(attr, true);
+
     // as soon as the hcls changes, the guard on hidden class won't pass.
     HCAttrs* attrs = getAttrsPtr();
     HiddenClass* hcls = attrs->hcls;
@@ -2765,17 +3069,21 @@ void Box::delattr(const std::string& attr, DelattrRewriteArgs* rewrite_args) {
     // The order of attributes is pertained as delAttrToMakeHC constructs
     // the new HiddenClass by invoking getOrMakeChild in the prevous order
     // of remaining attributes
-    int num_attrs = hcls->attr_offsets.size();
+    int num_attrs = hcls->numAttrs();
     int offset = hcls->getOffset(attr);
     assert(offset >= 0);
-    Box** start = attrs->attr_list->attrs;
-    memmove(start + offset, start + offset + 1, (num_attrs - offset - 1) * sizeof(Box*));
+    for (int i = offset; i < num_attrs - 1; i++) {
+        *attrs->getSlot(i) = *attrs->getSlot(i + 1);
+    }
 
     attrs->hcls = new_hcls;
 
-    // guarantee the size of the attr_list equals the number of attrs
-    int new_size = sizeof(HCAttrs::AttrList) + sizeof(Box*) * (num_attrs - 1);
-    attrs->attr_list = (HCAttrs::AttrList*)gc::gc_realloc(attrs->attr_list, new_size);
+    // guarantee the size of the attr_list equals the number of attrs that don't fit inline
+    int num_outline = num_attrs - hcls->num_inline;
+    if (num_outline > 0) {
+        int new_size = sizeof(HCAttrs::AttrList) + sizeof(Box*) * (num_outline - 1);
+        attrs->attr_list = (HCAttrs::AttrList*)gc::gc_realloc(attrs->attr_list, new_size);
+    }
 }
 
 extern "C" void delattr_internal(Box* obj, const std::string& attr, bool allow_custom,
@@ -2812,7 +3120,7 @@ extern "C" void delattr_internal(Box* obj, const std::string& attr, bool allow_c
     } else {
         // the exception cpthon throws is different when the class contains the attribute
         if (clsAttr != NULL) {
-            raiseExcHelper(AttributeError, "'%s' object attribute '%s' is read-only", getTypeName(obj)->c_str(),
+            raiseExcHelper(AttributeError, "'%s' object attribute '%s' is read-only", getTypeName(obj),
                            attr.c_str());
         } else {
             raiseAttributeError(obj, attr.c_str());
@@ -2821,7 +3129,7 @@ extern "C" void delattr_internal(Box* obj, const std::string& attr, bool allow_c
 }
 
 // del target.attr
-extern "C" void delattr(Box* obj, const char* attr) {
+extern "C" void delattr(Box* obj, const std::string* attr) {
     static StatCounter slowpath_delattr("slowpath_delattr");
     slowpath_delattr.log();
 
@@ -2829,18 +3137,18 @@ extern "C" void delattr(Box* obj, const char* attr) {
         BoxedClass* cobj = static_cast<BoxedClass*>(obj);
         if (!isUserDefined(cobj)) {
             raiseExcHelper(TypeError, "can't set attributes of built-in/extension type '%s'\n",
-                           getNameOfClass(cobj)->c_str());
+                           getNameOfClass(cobj));
         }
     }
 
 
-    delattr_internal(obj, attr, true, NULL);
+    delattr_internal(obj, *attr, true, NULL);
 }
 
 // For use on __init__ return values
 static void assertInitNone(Box* obj) {
     if (obj != None) {
-        raiseExcHelper(TypeError, "__init__() should return None, not '%s'", getTypeName(obj)->c_str());
+        raiseExcHelper(TypeError, "__init__() should return None, not '%s'", getTypeName(obj));
     }
 }
 
@@ -2878,7 +3186,7 @@ Box* typeCallInternal(BoxedFunction* f, CallRewriteArgs* rewrite_args, ArgPassSp
     Box* cls = arg1;
     if (cls->cls != type_cls) {
         raiseExcHelper(TypeError, "descriptor '__call__' requires a 'type' object but received an '%s'",
-                       getTypeName(cls)->c_str());
+                       getTypeName(cls));
     }
 
     BoxedClass* ccls = static_cast<BoxedClass*>(cls);
@@ -3023,6 +3331,7 @@ Box* typeCallInternal(BoxedFunction* f, CallRewriteArgs* rewrite_args, ArgPassSp
 
 Box* typeCall(Box* obj, BoxedList* vararg) {
     assert(vararg->cls == list_cls);
+    vararg->convertToObjects();
     if (vararg->size == 0)
         return typeCallInternal1(NULL, NULL, ArgPassSpec(1), obj);
     else if (vararg->size == 1)
@@ -3065,6 +3374,36 @@ extern "C" Box* getGlobal(BoxedModule* m, std::string* name) {
         std::unique_ptr<Rewriter> rewriter(
             Rewriter::createRewriter(__builtin_extract_return_addr(__builtin_return_address(0)), 3, "getGlobal"));
 
+        // If the global (and the builtin it would fall back to) hasn't been rebound, embed its value
+        // directly and rely on the module invalidating us if that changes, rather than guarding on
+        // the module's hidden class and loading the attribute every time.
+        if (rewriter.get() && m->canEmbedGlobal(*name) && builtins_module->canEmbedGlobal(*name)) {
+            BoxedModule* found_in = m;
+            Box* r = m->getattr(*name, NULL);
+            if (!r && *name != "__builtins__") {
+                found_in = builtins_module;
+                r = builtins_module->getattr(*name, NULL);
+            }
+
+            if (r) {
+                static StatCounter embedded_getglobal("getglobal_embedded");
+                embedded_getglobal.log();
+
+                RewriterVarUsage r_module = rewriter->getArg(0);
+                r_module.addGuard((intptr_t)m);
+                r_module.setDoneUsing();
+
+                rewriter->addDependenceOn(m->getGlobalInvalidator(*name));
+                if (found_in != m)
+                    rewriter->addDependenceOn(found_in->getGlobalInvalidator(*name));
+                rewriter->setDoneGuarding();
+
+                RewriterVarUsage r_rtn = rewriter->loadConst((intptr_t)r, rewriter->getReturnDestination());
+                rewriter->commitReturning(std::move(r_rtn));
+                return r;
+            }
+        }
+
         Box* r;
         if (rewriter.get()) {
             // rewriter->trap();
@@ -3155,7 +3494,7 @@ extern "C" Box* import(const std::string* name) {
 
     llvm::SmallString<128> joined_path;
     for (int i = 0; i < sys_path->size; i++) {
-        Box* _p = sys_path->elts->elts[i];
+        Box* _p = sys_path->getitem(i);
         if (_p->cls != str_cls)
             continue;
         BoxedString* p = static_cast<BoxedString*>(_p);
@@ -3217,7 +3556,7 @@ extern "C" void importStar(Box* _from_module, BoxedModule* to_module) {
     if (all) {
         Box* all_getitem = typeLookup(all->cls, getitem_str, NULL);
         if (!all_getitem)
-            raiseExcHelper(TypeError, "'%s' object does not support indexing", getTypeName(all)->c_str());
+            raiseExcHelper(TypeError, "'%s' object does not support indexing", getTypeName(all));
 
         int idx = 0;
         while (true) {
@@ -3232,25 +3571,26 @@ extern "C" void importStar(Box* _from_module, BoxedModule* to_module) {
             idx++;
 
             if (attr_name->cls != str_cls)
-                raiseExcHelper(TypeError, "attribute name must be string, not '%s'", getTypeName(attr_name)->c_str());
+                raiseExcHelper(TypeError, "attribute name must be string, not '%s'", getTypeName(attr_name));
 
             BoxedString* casted_attr_name = static_cast<BoxedString*>(attr_name);
-            Box* attr_value = from_module->getattr(casted_attr_name->s);
+            Box* attr_value = from_module->getattr(casted_attr_name->s.str());
 
             if (!attr_value)
-                raiseExcHelper(AttributeError, "'module' object has no attribute '%s'", casted_attr_name->s.c_str());
+                raiseExcHelper(AttributeError, "'module' object has no attribute '%s'", casted_attr_name->c_str());
 
-            to_module->setattr(casted_attr_name->s, attr_value, NULL);
+            to_module->setattr(casted_attr_name->s.str(), attr_value, NULL);
         }
         return;
     }
 
     HCAttrs* module_attrs = from_module->getAttrsPtr();
-    for (auto& p : module_attrs->hcls->attr_offsets) {
-        if (p.first[0] == '_')
+    std::vector<const std::string*> attr_names = module_attrs->hcls->getAttrNames();
+    for (size_t i = 0; i < attr_names.size(); i++) {
+        if ((*attr_names[i])[0] == '_')
             continue;
 
-        to_module->setattr(p.first, module_attrs->attr_list->attrs[p.second], NULL);
+        to_module->setattr(*attr_names[i], *module_attrs->getSlot(i), NULL);
     }
 }
 }
@@ -37,13 +37,13 @@ void raiseExc(Box* exc_obj) __attribute__((__noreturn__));
 // helper function for raising from the runtime:
 void raiseExcHelper(BoxedClass*, const char* fmt, ...) __attribute__((__noreturn__));
 
-extern "C" const std::string* getNameOfClass(BoxedClass* cls);
+extern "C" const char* getNameOfClass(BoxedClass* cls);
 
 // TODO sort this
 extern "C" void my_assert(bool b);
-extern "C" Box* getattr(Box* obj, const char* attr);
-extern "C" void setattr(Box* obj, const char* attr, Box* attr_val);
-extern "C" void delattr(Box* obj, const char* attr);
+extern "C" Box* getattr(Box* obj, const std::string* attr);
+extern "C" void setattr(Box* obj, const std::string* attr, Box* attr_val);
+extern "C" void delattr(Box* obj, const std::string* attr);
 extern "C" bool nonzero(Box* obj);
 extern "C" Box* runtimeCall(Box*, ArgPassSpec, Box*, Box*, Box*, Box**, const std::vector<const std::string*>*);
 extern "C" Box* callattr(Box*, std::string*, bool, ArgPassSpec, Box*, Box*, Box*, Box**,
@@ -55,7 +55,7 @@ extern "C" BoxedString* strOrNull(Box* obj);  // similar to str, but returns NUL
 extern "C" bool isinstance(Box* obj, Box* cls, int64_t flags);
 extern "C" BoxedInt* hash(Box* obj);
 // extern "C" Box* abs_(Box* obj);
-Box* open(Box* arg1, Box* arg2);
+Box* open(Box* arg1, Box* arg2, Box* arg3);
 // extern "C" Box* chr(Box* arg);
 extern "C" Box* compare(Box*, Box*, int);
 extern "C" BoxedInt* len(Box* obj);
@@ -69,7 +69,7 @@ extern "C" void delGlobal(BoxedModule* m, std::string* name);
 extern "C" Box* getitem(Box* value, Box* slice);
 extern "C" void setitem(Box* target, Box* slice, Box* value);
 extern "C" void delitem(Box* target, Box* slice);
-extern "C" Box* getclsattr(Box* obj, const char* attr);
+extern "C" Box* getclsattr(Box* obj, const std::string* attr);
 extern "C" Box* unaryop(Box* operand, int op_type);
 extern "C" Box* import(const std::string* name);
 extern "C" Box* importFrom(Box* obj, const std::string* attr);
@@ -212,7 +212,7 @@ void raise3(Box* arg0, Box* arg1, Box* arg2) {
             raiseExc(exc_obj);
         } else {
             raiseExcHelper(TypeError, "exceptions must be old-style classes or derived from BaseException, not %s",
-                           getTypeName(arg0)->c_str());
+                           getTypeName(arg0));
         }
     }
 
@@ -249,20 +249,19 @@ void raiseExcHelper(BoxedClass* cls, const char* msg, ...) {
 }
 
 std::string formatException(Box* b) {
-    const std::string* name = getTypeName(b);
+    std::string name = getTypeName(b);
 
     Box* attr = b->getattr("message");
     if (attr == nullptr)
-        return *name;
+        return name;
 
     BoxedString* r = strOrNull(attr);
     if (!r)
-        return *name;
+        return name;
 
     assert(r->cls == str_cls);
-    const std::string* msg = &r->s;
-    if (msg->size())
-        return *name + ": " + *msg;
-    return *name;
+    if (r->s.size())
+        return name + ": " + r->s.str();
+    return name;
 }
 }
@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <emmintrin.h>
 #include <sstream>
 #include <unordered_map>
 
@@ -30,15 +31,270 @@
 
 namespace pyston {
 
+namespace {
+struct StringRefHash {
+    size_t operator()(llvm::StringRef s) const { return llvm::hash_value(s); }
+};
+
+// The intern table only holds weak references to its strings: the keys point at the strings' own
+// storage, and the table isn't scanned by the GC, so strings that aren't used anywhere else get
+// collected and then removed from the table by clearDeadInternedStrings.
+typedef std::unordered_map<llvm::StringRef, BoxedString*, StringRefHash> InternTable;
+
+void clearDeadInternedStrings();
+
+InternTable& getInternTable() {
+    static InternTable* table = NULL;
+    if (!table) {
+        table = new InternTable();
+        gc::registerWeakRefClearer(clearDeadInternedStrings);
+    }
+    return *table;
+}
+
+void clearDeadInternedStrings() {
+    static StatCounter sc("interned_strings_freed");
+
+    InternTable& table = getInternTable();
+    for (auto it = table.begin(); it != table.end();) {
+        if (gc::isReachable(it->second)) {
+            ++it;
+        } else {
+            sc.log();
+            it = table.erase(it);
+        }
+    }
+}
+
+// Identifier-like strings are the ones that are likely to get used as attribute names or dict keys.
+const int MAX_NAME_LIKE_LENGTH = 40;
+bool isNameLike(llvm::StringRef s) {
+    if (s.size() > MAX_NAME_LIKE_LENGTH)
+        return false;
+    for (char c : s) {
+        if (!(('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9') || c == '_'))
+            return false;
+    }
+    return true;
+}
+}
+
+BoxedString* internString(llvm::StringRef s) {
+    InternTable& table = getInternTable();
+    auto it = table.find(s);
+    if (it != table.end())
+        return it->second;
+
+    BoxedString* rtn = boxString(s);
+    rtn->interned = true;
+    table[rtn->s] = rtn;
+    return rtn;
+}
+
+BoxedString* internString(BoxedString* s) {
+    assert(s->cls == str_cls);
+    if (s->interned)
+        return s;
+
+    // The table's key has to stay valid for as long as the string is alive, which isn't the case for
+    // strings in a StringBuffer (c_str() might move them):
+    if (s->usesBuffer())
+        return internString(s->s);
+
+    InternTable& table = getInternTable();
+    auto it = table.find(s->s);
+    if (it != table.end())
+        return it->second;
+
+    s->interned = true;
+    table[s->s] = s;
+    return s;
+}
+
+// Vectorized helpers for the string methods that get used to chew through text.
+//
+// These only use SSE2, which every x86-64 cpu has: the runtime also gets compiled to bitcode for the
+// JIT, so we can't use per-function target attributes to dispatch to wider instruction sets.
+// (The memchr and memcmp calls below already go through glibc's own cpu dispatch.)
+namespace {
+const int VEC_SIZE = 16;
+
+inline __m128i loadVec(const char* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+// Bytes that are in [lo, lo+n]
+inline __m128i inRange(__m128i v, char lo, char n) {
+    __m128i offset = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(n)), offset);
+}
+
+// Python's whitespace characters: ' ' and '\t' through '\r'
+inline __m128i isSpaceVec(__m128i v) {
+    return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), inRange(v, '\t', '\r' - '\t'));
+}
+
+inline bool isSpace(char c) {
+    return c == ' ' || ('\t' <= c && c <= '\r');
+}
+
+// Returns the first position in [p, end) whose whitespace-ness is "space", or end if there isn't one.
+const char* findSpaceOrNot(const char* p, const char* end, bool space) {
+    int flip = space ? 0 : 0xffff;
+    while (end - p >= VEC_SIZE) {
+        int mask = _mm_movemask_epi8(isSpaceVec(loadVec(p))) ^ flip;
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += VEC_SIZE;
+    }
+    while (p < end && isSpace(*p) != space)
+        p++;
+    return p;
+}
+
+size_t countChar(llvm::StringRef s, char c) {
+    const char* p = s.data();
+    const char* end = p + s.size();
+    __m128i needle = _mm_set1_epi8(c);
+    size_t count = 0;
+    while (end - p >= VEC_SIZE) {
+        count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(loadVec(p), needle)));
+        p += VEC_SIZE;
+    }
+    for (; p < end; p++) {
+        if (*p == c)
+            count++;
+    }
+    return count;
+}
+}
+
+// For needles longer than one character, this compares the first and last characters of the needle
+// against 16 candidate positions at a time, and only looks at the rest of the needle for candidates
+// that match both.
+size_t findSubstring(llvm::StringRef haystack, llvm::StringRef needle, size_t start) {
+    size_t n = haystack.size(), k = needle.size();
+    if (start > n || k > n - start)
+        return llvm::StringRef::npos;
+    if (k == 0)
+        return start;
+
+    const char* h = haystack.data();
+    if (k == 1) {
+        const void* found = memchr(h + start, needle[0], n - start);
+        return found ? static_cast<const char*>(found) - h : llvm::StringRef::npos;
+    }
+
+    __m128i first = _mm_set1_epi8(needle[0]);
+    __m128i last = _mm_set1_epi8(needle[k - 1]);
+    size_t i = start;
+    for (; i + k - 1 + VEC_SIZE <= n; i += VEC_SIZE) {
+        __m128i eq_first = _mm_cmpeq_epi8(loadVec(h + i), first);
+        __m128i eq_last = _mm_cmpeq_epi8(loadVec(h + i + k - 1), last);
+        int mask = _mm_movemask_epi8(_mm_and_si128(eq_first, eq_last));
+        while (mask) {
+            int bit = __builtin_ctz(mask);
+            if (memcmp(h + i + bit + 1, needle.data() + 1, k - 2) == 0)
+                return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    for (; i + k <= n; i++) {
+        if (h[i] == needle[0] && memcmp(h + i + 1, needle.data() + 1, k - 1) == 0)
+            return i;
+    }
+    return llvm::StringRef::npos;
+}
+
+namespace {
+// Copies n bytes from src to dest, adding delta to the ones in [lo, lo+25].
+void shiftCase(char* dest, const char* src, size_t n, char lo, char delta) {
+    size_t i = 0;
+    __m128i vdelta = _mm_set1_epi8(delta);
+    for (; i + VEC_SIZE <= n; i += VEC_SIZE) {
+        __m128i v = loadVec(src + i);
+        v = _mm_add_epi8(v, _mm_and_si128(inRange(v, lo, 25), vdelta));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), v);
+    }
+    for (; i < n; i++) {
+        char c = src[i];
+        dest[i] = (lo <= c && c <= lo + 25) ? c + delta : c;
+    }
+}
+}
+
+BoxedString* internIfNameLike(llvm::StringRef s) {
+    if (isNameLike(s))
+        return internString(s);
+    return boxString(s);
+}
+
+const char* BoxedString::c_str() {
+    if (!usesBuffer())
+        return s.data();
+
+    // A string in a StringBuffer is followed by whatever got appended after it.  If nothing has been
+    // appended yet, stop anything from being appended later, so that the pointer we return stays
+    // NUL-terminated; otherwise switch to a copy of our own.
+    StringBuffer* buffer = getBuffer();
+    if (buffer->used == s.size()) {
+        buffer->capacity = buffer->used + 1;
+    } else {
+        static StatCounter sc("str_buffer_flattens");
+        sc.log();
+
+        StringBuffer* copy = StringBuffer::create(s.size() + 1);
+        memcpy(copy->chars, s.data(), s.size());
+        copy->chars[s.size()] = '\0';
+        copy->used = s.size();
+        s = llvm::StringRef(copy->chars, s.size());
+    }
+    assert(s.data()[s.size()] == '\0');
+    return s.data();
+}
+
+// Concatenations that produce strings at least this long put the result in a StringBuffer with some
+// room to spare, so that loops doing "s += piece" can append in place instead of copying s every time.
+static const size_t MIN_BUFFERED_CONCAT_SIZE = 64;
+
 extern "C" BoxedString* strAdd(BoxedString* lhs, Box* _rhs) {
     assert(lhs->cls == str_cls);
 
     if (_rhs->cls != str_cls) {
-        raiseExcHelper(TypeError, "cannot concatenate 'str' and '%s' objects", getTypeName(_rhs)->c_str());
+        raiseExcHelper(TypeError, "cannot concatenate 'str' and '%s' objects", getTypeName(_rhs));
     }
 
     BoxedString* rhs = static_cast<BoxedString*>(_rhs);
-    return new BoxedString(lhs->s + rhs->s);
+    size_t lsize = lhs->s.size(), rsize = rhs->s.size();
+    size_t size = lsize + rsize;
+
+    if (lhs->usesBuffer()) {
+        StringBuffer* buffer = lhs->getBuffer();
+        if (buffer->used == lsize && buffer->capacity > size) {
+            static StatCounter sc("str_appends_in_place");
+            sc.log();
+
+            // rhs might point into this same buffer, but only before lsize, so this doesn't overlap:
+            memcpy(buffer->chars + lsize, rhs->s.data(), rsize);
+            buffer->chars[size] = '\0';
+            buffer->used = size;
+            return new (0) BoxedString(buffer, size);
+        }
+    }
+
+    if (size >= MIN_BUFFERED_CONCAT_SIZE) {
+        StringBuffer* buffer = StringBuffer::create(2 * size + 1);
+        memcpy(buffer->chars, lhs->s.data(), lsize);
+        memcpy(buffer->chars + lsize, rhs->s.data(), rsize);
+        buffer->chars[size] = '\0';
+        buffer->used = size;
+        return new (0) BoxedString(buffer, size);
+    }
+
+    BoxedString* rtn = BoxedString::createUninitialized(size);
+    memcpy(rtn->storage(), lhs->s.data(), lsize);
+    memcpy(rtn->storage() + lsize, rhs->s.data(), rsize);
+    return rtn;
 }
 
 extern "C" Box* strMod(BoxedString* lhs, Box* rhs) {
@@ -53,7 +309,7 @@ extern "C" Box* strMod(BoxedString* lhs, Box* rhs) {
         _elts.push_back(rhs);
     }
 
-    const char* fmt = lhs->s.c_str();
+    const char* fmt = lhs->s.data();
     const char* fmt_end = fmt + lhs->s.size();
 
     int elt_num = 0;
@@ -111,7 +367,7 @@ extern "C" Box* strMod(BoxedString* lhs, Box* rhs) {
                     elt_num++;
 
                     BoxedString* s = str(b);
-                    os << s->s;
+                    os.write(s->s.data(), s->s.size());
                     break;
                 } else if (c == 'd') {
                     RELEASE_ASSERT(elt_num < num_elts, "insufficient number of arguments for format string");
@@ -181,13 +437,12 @@ extern "C" BoxedString* strMul(BoxedString* lhs, BoxedInt* rhs) {
 
     int sz = lhs->s.size();
     int n = rhs->n;
-    char* buf = new char[sz * n + 1];
+    BoxedString* rtn = BoxedString::createUninitialized(sz * n);
+    char* buf = rtn->storage();
     for (int i = 0; i < n; i++) {
-        memcpy(buf + (sz * i), lhs->s.c_str(), sz);
+        memcpy(buf + (sz * i), lhs->s.data(), sz);
     }
-    buf[sz * n] = '\0';
-
-    return new BoxedString(buf);
+    return rtn;
 }
 
 extern "C" Box* strLt(BoxedString* lhs, Box* rhs) {
@@ -237,7 +492,7 @@ extern "C" Box* strEq(BoxedString* lhs, Box* rhs) {
         return boxBool(false);
 
     BoxedString* srhs = static_cast<BoxedString*>(rhs);
-    return boxBool(lhs->s == srhs->s);
+    return boxBool(BoxedString::equal(lhs, srhs));
 }
 
 extern "C" Box* strNe(BoxedString* lhs, Box* rhs) {
@@ -247,7 +502,7 @@ extern "C" Box* strNe(BoxedString* lhs, Box* rhs) {
         return boxBool(true);
 
     BoxedString* srhs = static_cast<BoxedString*>(rhs);
-    return boxBool(lhs->s != srhs->s);
+    return boxBool(!BoxedString::equal(lhs, srhs));
 }
 
 extern "C" Box* strLen(BoxedString* self) {
@@ -285,7 +540,7 @@ extern "C" Box* strRepr(BoxedString* self) {
 
     std::ostringstream os("");
 
-    const std::string& s = self->s;
+    llvm::StringRef s = self->s;
     char quote = '\'';
     if (s.find('\'', 0) != std::string::npos && s.find('\"', 0) == std::string::npos) {
         quote = '\"';
@@ -336,8 +591,7 @@ extern "C" Box* strRepr(BoxedString* self) {
 extern "C" Box* strHash(BoxedString* self) {
     assert(self->cls == str_cls);
 
-    std::hash<std::string> H;
-    return boxInt(H(self->s));
+    return boxInt(self->hash());
 }
 
 extern "C" Box* strNonzero(BoxedString* self) {
@@ -355,7 +609,7 @@ extern "C" Box* strNew(BoxedClass* cls, Box* obj) {
 Box* _strSlice(BoxedString* self, i64 start, i64 stop, i64 step) {
     assert(self->cls == str_cls);
 
-    const std::string& s = self->s;
+    llvm::StringRef s = self->s;
 
     assert(step != 0);
     if (step > 0) {
@@ -366,20 +620,26 @@ Box* _strSlice(BoxedString* self, i64 start, i64 stop, i64 step) {
         assert(-1 <= stop);
     }
 
-    std::vector<char> chars;
-    int cur = start;
-    while ((step > 0 && cur < stop) || (step < 0 && cur > stop)) {
-        chars.push_back(s[cur]);
-        cur += step;
-    }
-    // TODO too much copying
-    return boxString(std::string(chars.begin(), chars.end()));
+    if (step == 1)
+        return boxString(s.slice(start, stop));
+
+    i64 length = 0;
+    if (step > 0 && stop > start)
+        length = (stop - start + step - 1) / step;
+    else if (step < 0 && start > stop)
+        length = (start - stop - step - 1) / (-step);
+
+    BoxedString* rtn = BoxedString::createUninitialized(length);
+    char* buf = rtn->storage();
+    for (i64 i = 0, cur = start; i < length; i++, cur += step)
+        buf[i] = s[cur];
+    return rtn;
 }
 
 Box* strIsAlpha(BoxedString* self) {
     assert(self->cls == str_cls);
 
-    const std::string& str(self->s);
+    llvm::StringRef str(self->s);
     if (str.empty())
         return False;
 
@@ -394,7 +654,7 @@ Box* strIsAlpha(BoxedString* self) {
 Box* strIsDigit(BoxedString* self) {
     assert(self->cls == str_cls);
 
-    const std::string& str(self->s);
+    llvm::StringRef str(self->s);
     if (str.empty())
         return False;
 
@@ -409,7 +669,7 @@ Box* strIsDigit(BoxedString* self) {
 Box* strIsAlnum(BoxedString* self) {
     assert(self->cls == str_cls);
 
-    const std::string& str(self->s);
+    llvm::StringRef str(self->s);
     if (str.empty())
         return False;
 
@@ -424,7 +684,7 @@ Box* strIsAlnum(BoxedString* self) {
 Box* strIsLower(BoxedString* self) {
     assert(self->cls == str_cls);
 
-    const std::string& str(self->s);
+    llvm::StringRef str(self->s);
     bool lowered = false;
 
     if (str.empty())
@@ -446,7 +706,7 @@ Box* strIsLower(BoxedString* self) {
 Box* strIsUpper(BoxedString* self) {
     assert(self->cls == str_cls);
 
-    const std::string& str(self->s);
+    llvm::StringRef str(self->s);
     bool uppered = false;
 
     if (str.empty())
@@ -468,7 +728,7 @@ Box* strIsUpper(BoxedString* self) {
 Box* strIsSpace(BoxedString* self) {
     assert(self->cls == str_cls);
 
-    const std::string& str(self->s);
+    llvm::StringRef str(self->s);
     if (str.empty())
         return False;
 
@@ -483,7 +743,7 @@ Box* strIsSpace(BoxedString* self) {
 Box* strIsTitle(BoxedString* self) {
     assert(self->cls == str_cls);
 
-    const std::string& str(self->s);
+    llvm::StringRef str(self->s);
 
     if (str.empty())
         return False;
@@ -520,12 +780,43 @@ Box* strJoin(BoxedString* self, Box* rhs) {
 
     if (rhs->cls == list_cls) {
         BoxedList* list = static_cast<BoxedList*>(rhs);
+
+        // If everything is already a string, we can size the result up front and copy straight into it:
+        size_t size = 0;
+        bool all_strs = list->strategy == BoxedList::OBJECT;
+        for (int i = 0; all_strs && i < list->size; i++) {
+            Box* elt = list->elts->elts[i];
+            if (elt->cls != str_cls) {
+                all_strs = false;
+                break;
+            }
+            size += static_cast<BoxedString*>(elt)->s.size();
+        }
+
+        if (all_strs) {
+            if (list->size)
+                size += self->s.size() * (list->size - 1);
+            BoxedString* rtn = BoxedString::createUninitialized(size);
+            char* p = rtn->storage();
+            for (int i = 0; i < list->size; i++) {
+                if (i > 0) {
+                    memcpy(p, self->s.data(), self->s.size());
+                    p += self->s.size();
+                }
+                llvm::StringRef elt = static_cast<BoxedString*>(list->elts->elts[i])->s;
+                memcpy(p, elt.data(), elt.size());
+                p += elt.size();
+            }
+            assert(p == rtn->storage() + size);
+            return rtn;
+        }
+
         std::ostringstream os;
         for (int i = 0; i < list->size; i++) {
             if (i > 0)
-                os << self->s;
-            BoxedString* elt_str = str(list->elts->elts[i]);
-            os << elt_str->s;
+                os.write(self->s.data(), self->s.size());
+            BoxedString* elt_str = str(list->getitem(i));
+            os.write(elt_str->s.data(), elt_str->s.size());
         }
         return boxString(os.str());
     } else {
@@ -538,12 +829,17 @@ Box* strSplit(BoxedString* self, BoxedString* sep) {
 
     if (sep->cls == str_cls) {
         if (!sep->s.empty()) {
-            llvm::SmallVector<llvm::StringRef, 16> parts;
-            llvm::StringRef(self->s).split(parts, sep->s);
-
+            llvm::StringRef s = self->s;
             BoxedList* rtn = new BoxedList();
-            for (const auto& s : parts)
-                listAppendInternal(rtn, boxString(s.str()));
+            size_t start = 0;
+            while (true) {
+                size_t found = findSubstring(s, sep->s, start);
+                if (found == llvm::StringRef::npos)
+                    break;
+                listAppendInternal(rtn, internIfNameLike(s.slice(start, found)));
+                start = found + sep->s.size();
+            }
+            listAppendInternal(rtn, internIfNameLike(s.substr(start)));
             return rtn;
         } else {
             raiseExcHelper(ValueError, "empty separator");
@@ -551,19 +847,14 @@ Box* strSplit(BoxedString* self, BoxedString* sep) {
     } else if (sep->cls == none_cls) {
         BoxedList* rtn = new BoxedList();
 
-        std::ostringstream os("");
-        for (char c : self->s) {
-            if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v') {
-                if (os.tellp()) {
-                    listAppendInternal(rtn, boxString(os.str()));
-                    os.str("");
-                }
-            } else {
-                os << c;
-            }
-        }
-        if (os.tellp()) {
-            listAppendInternal(rtn, boxString(os.str()));
+        const char* p = self->s.data();
+        const char* end = p + self->s.size();
+        while (true) {
+            const char* word_start = findSpaceOrNot(p, end, false);
+            if (word_start == end)
+                break;
+            p = findSpaceOrNot(word_start, end, true);
+            listAppendInternal(rtn, internIfNameLike(llvm::StringRef(word_start, p - word_start)));
         }
         return rtn;
     } else {
@@ -575,9 +866,15 @@ Box* strStrip(BoxedString* self, Box* chars) {
     assert(self->cls == str_cls);
 
     if (chars->cls == str_cls) {
-        return new BoxedString(llvm::StringRef(self->s).trim(static_cast<BoxedString*>(chars)->s));
+        return boxString(self->s.trim(static_cast<BoxedString*>(chars)->s));
     } else if (chars->cls == none_cls) {
-        return new BoxedString(llvm::StringRef(self->s).trim(" \t\n\r\f\v"));
+        const char* start = self->s.data();
+        const char* end = start + self->s.size();
+        while (start < end && isSpace(*start))
+            start++;
+        while (end > start && isSpace(end[-1]))
+            end--;
+        return boxString(llvm::StringRef(start, end - start));
     } else {
         raiseExcHelper(TypeError, "strip arg must be None, str or unicode");
     }
@@ -587,9 +884,13 @@ Box* strLStrip(BoxedString* self, Box* chars) {
     assert(self->cls == str_cls);
 
     if (chars->cls == str_cls) {
-        return new BoxedString(llvm::StringRef(self->s).ltrim(static_cast<BoxedString*>(chars)->s));
+        return boxString(self->s.ltrim(static_cast<BoxedString*>(chars)->s));
     } else if (chars->cls == none_cls) {
-        return new BoxedString(llvm::StringRef(self->s).ltrim(" \t\n\r\f\v"));
+        const char* start = self->s.data();
+        const char* end = start + self->s.size();
+        while (start < end && isSpace(*start))
+            start++;
+        return boxString(llvm::StringRef(start, end - start));
     } else {
         raiseExcHelper(TypeError, "lstrip arg must be None, str or unicode");
     }
@@ -599,9 +900,13 @@ Box* strRStrip(BoxedString* self, Box* chars) {
     assert(self->cls == str_cls);
 
     if (chars->cls == str_cls) {
-        return new BoxedString(llvm::StringRef(self->s).rtrim(static_cast<BoxedString*>(chars)->s));
+        return boxString(self->s.rtrim(static_cast<BoxedString*>(chars)->s));
     } else if (chars->cls == none_cls) {
-        return new BoxedString(llvm::StringRef(self->s).rtrim(" \t\n\r\f\v"));
+        const char* start = self->s.data();
+        const char* end = start + self->s.size();
+        while (end > start && isSpace(end[-1]))
+            end--;
+        return boxString(llvm::StringRef(start, end - start));
     } else {
         raiseExcHelper(TypeError, "rstrip arg must be None, str or unicode");
     }
@@ -649,12 +954,16 @@ Box* strTitle(BoxedString* self) {
 
 Box* strLower(BoxedString* self) {
     assert(self->cls == str_cls);
-    return boxString(llvm::StringRef(self->s).lower());
+    BoxedString* rtn = BoxedString::createUninitialized(self->s.size());
+    shiftCase(rtn->storage(), self->s.data(), self->s.size(), 'A', 'a' - 'A');
+    return rtn;
 }
 
 Box* strUpper(BoxedString* self) {
     assert(self->cls == str_cls);
-    return boxString(llvm::StringRef(self->s).upper());
+    BoxedString* rtn = BoxedString::createUninitialized(self->s.size());
+    shiftCase(rtn->storage(), self->s.data(), self->s.size(), 'a', 'A' - 'a');
+    return rtn;
 }
 
 Box* strSwapcase(BoxedString* self) {
@@ -673,12 +982,12 @@ Box* strSwapcase(BoxedString* self) {
 Box* strContains(BoxedString* self, Box* elt) {
     assert(self->cls == str_cls);
     if (elt->cls != str_cls)
-        raiseExcHelper(TypeError, "'in <string>' requires string as left operand, not %s", getTypeName(elt)->c_str());
+        raiseExcHelper(TypeError, "'in <string>' requires string as left operand, not %s", getTypeName(elt));
 
     BoxedString* sub = static_cast<BoxedString*>(elt);
 
-    size_t found_idx = self->s.find(sub->s);
-    if (found_idx == std::string::npos)
+    size_t found_idx = findSubstring(self->s, sub->s);
+    if (found_idx == llvm::StringRef::npos)
         return False;
     return True;
 }
@@ -699,7 +1008,7 @@ extern "C" Box* strGetitem(BoxedString* self, Box* slice) {
         }
 
         char c = self->s[n];
-        return new BoxedString(std::string(1, c));
+        return internString(llvm::StringRef(&c, 1));
     } else if (slice->cls == slice_cls) {
         BoxedSlice* sslice = static_cast<BoxedSlice*>(slice);
 
@@ -707,7 +1016,7 @@ extern "C" Box* strGetitem(BoxedString* self, Box* slice) {
         parseSlice(sslice, self->s.size(), &start, &stop, &step);
         return _strSlice(self, start, stop, step);
     } else {
-        raiseExcHelper(TypeError, "string indices must be integers, not %s", getTypeName(slice)->c_str());
+        raiseExcHelper(TypeError, "string indices must be integers, not %s", getTypeName(slice));
     }
 }
 
@@ -721,7 +1030,7 @@ BoxedClass* str_iterator_cls = NULL;
 class BoxedStringIterator : public Box {
 public:
     BoxedString* s;
-    std::string::const_iterator it, end;
+    llvm::StringRef::iterator it, end;
 
     BoxedStringIterator(BoxedString* s) : Box(str_iterator_cls), s(s), it(s->s.begin()), end(s->s.end()) {}
 
@@ -741,7 +1050,7 @@ public:
 
         char c = *self->it;
         ++self->it;
-        return new BoxedString(std::string(1, c));
+        return internString(llvm::StringRef(&c, 1));
     }
 };
 
@@ -762,14 +1071,19 @@ int64_t strCount2Unboxed(BoxedString* self, Box* elt) {
     if (elt->cls != str_cls)
         raiseExcHelper(TypeError, "expected a character buffer object");
 
-    const std::string& s = self->s;
-    const std::string& pattern = static_cast<BoxedString*>(elt)->s;
+    llvm::StringRef s = self->s;
+    llvm::StringRef pattern = static_cast<BoxedString*>(elt)->s;
+
+    if (pattern.size() == 0)
+        return s.size() + 1;
+    if (pattern.size() == 1)
+        return countChar(s, pattern[0]);
 
     int found = 0;
     size_t start = 0;
     while (start < s.size()) {
-        size_t next = s.find(pattern, start);
-        if (next == std::string::npos)
+        size_t next = findSubstring(s, pattern, start);
+        if (next == llvm::StringRef::npos)
             break;
 
         found++;
@@ -783,7 +1097,7 @@ Box* strCount2(BoxedString* self, Box* elt) {
 }
 
 void setupStr() {
-    str_iterator_cls = new BoxedClass(object_cls, &strIteratorGCHandler, 0, sizeof(BoxedString), false);
+    str_iterator_cls = new BoxedClass(object_cls, &strIteratorGCHandler, 0, sizeof(BoxedStringIterator), false);
     gc::registerStaticRootObj(str_iterator_cls);
     str_iterator_cls->giveAttr("__name__", boxStrConstant("striterator"));
     str_iterator_cls->giveAttr("__hasnext__",
@@ -0,0 +1,463 @@
+// Copyright (c) 2014 Dropbox, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PYSTON_RUNTIME_TIMSORT_H
+#define PYSTON_RUNTIME_TIMSORT_H
+
+#include <algorithm>
+#include <cstring>
+#include <sys/types.h>
+
+#include "core/common.h"
+#include "core/types.h"
+#include "gc/gc_alloc.h"
+
+namespace pyston {
+
+// A stable, adaptive merge sort; this is the algorithm from CPython's listobject.c (see its listsort.txt).
+//
+// The array gets split into "runs" that are already in order (strictly descending runs are reversed
+// in place), short runs are extended to a minimum length with binary insertion sort, and the runs are
+// merged pairwise, keeping the pending run lengths balanced.  When one side of a merge keeps winning,
+// the merge switches to "galloping" and copies whole stretches at once.  Sorted or partially sorted
+// input therefore takes close to n comparisons instead of n log n.
+//
+// T has to be trivially copyable (a Box*, or a struct of them), and Lt a strict weak ordering on it.
+// Lt is allowed to throw: every element is always either in the array or in the merge buffer, and
+// the merges copy their buffer back before letting an exception through, so the array still holds
+// the same elements afterwards, in some order.  The merge buffer is conservatively scanned, so the
+// elements in it stay alive if a comparison ends up triggering a collection.
+template <typename T, typename Lt> class TimSort {
+private:
+    static const ssize_t MIN_MERGE = 64;
+    static const int MIN_GALLOP = 7;
+    // With the run-length invariants that mergeCollapse maintains, this is enough for 2**64 elements.
+    static const int MAX_RUNS = 85;
+
+    struct Run {
+        ssize_t base, len;
+    };
+
+    T* a;
+    Lt lt;
+    int min_gallop;
+
+    T* tmp;
+    ssize_t tmp_size;
+
+    Run runs[MAX_RUNS];
+    int num_runs;
+
+    TimSort(T* a, Lt lt) : a(a), lt(lt), min_gallop(MIN_GALLOP), tmp(NULL), tmp_size(0), num_runs(0) {}
+    ~TimSort() {
+        if (tmp)
+            gc::gc_free(tmp);
+    }
+
+    void ensureTmp(ssize_t n) {
+        if (tmp_size < n) {
+            if (tmp)
+                gc::gc_free(tmp);
+            tmp = NULL; // in case the allocation triggers a collection
+            tmp = (T*)gc::gc_alloc(n * sizeof(T), gc::GCKind::CONSERVATIVE);
+            tmp_size = n;
+        }
+    }
+
+    // Runs shorter than this get extended with insertion sort; it is chosen so that n / minrun is
+    // a power of two, or a bit less than one, which keeps the final merges balanced.
+    static ssize_t minRunLength(ssize_t n) {
+        ssize_t r = 0;
+        while (n >= MIN_MERGE) {
+            r |= n & 1;
+            n >>= 1;
+        }
+        return n + r;
+    }
+
+    // Returns the length of the run starting at lo, making it ascending if it was descending.
+    // Descending runs have to be strictly descending so that reversing them keeps the sort stable.
+    ssize_t countRun(ssize_t lo, ssize_t hi) {
+        if (lo + 1 == hi)
+            return 1;
+
+        ssize_t n = 2;
+        if (lt(a[lo + 1], a[lo])) {
+            while (lo + n < hi && lt(a[lo + n], a[lo + n - 1]))
+                n++;
+            std::reverse(a + lo, a + lo + n);
+        } else {
+            while (lo + n < hi && !lt(a[lo + n], a[lo + n - 1]))
+                n++;
+        }
+        return n;
+    }
+
+    // Sorts a[lo:hi], given that a[lo:start] is already sorted.
+    void binaryInsertionSort(ssize_t lo, ssize_t hi, ssize_t start) {
+        for (ssize_t i = start; i < hi; i++) {
+            T pivot = a[i];
+            ssize_t l = lo, r = i;
+            while (l < r) {
+                ssize_t m = l + (r - l) / 2;
+                if (lt(pivot, a[m]))
+                    r = m;
+                else
+                    l = m + 1;
+            }
+            memmove(a + l + 1, a + l, (i - l) * sizeof(T));
+            a[l] = pivot;
+        }
+    }
+
+    // Returns k such that base[k-1] < key <= base[k], ie where key would go in front of any equal elements.
+    // The search starts at base[hint] and gallops outwards from there.
+    ssize_t gallopLeft(const T& key, T* base, ssize_t len, ssize_t hint) {
+        ssize_t last_ofs = 0, ofs = 1;
+        if (lt(base[hint], key)) {
+            ssize_t max_ofs = len - hint;
+            while (ofs < max_ofs && lt(base[hint + ofs], key)) {
+                last_ofs = ofs;
+                ofs = (ofs << 1) + 1;
+            }
+            ofs = std::min(ofs, max_ofs);
+            last_ofs += hint;
+            ofs += hint;
+        } else {
+            ssize_t max_ofs = hint + 1;
+            while (ofs < max_ofs && !lt(base[hint - ofs], key)) {
+                last_ofs = ofs;
+                ofs = (ofs << 1) + 1;
+            }
+            ofs = std::min(ofs, max_ofs);
+            ssize_t t = last_ofs;
+            last_ofs = hint - ofs;
+            ofs = hint - t;
+        }
+
+        // Now base[last_ofs] < key <= base[ofs]; binary search the rest of the way.
+        last_ofs++;
+        while (last_ofs < ofs) {
+            ssize_t m = last_ofs + (ofs - last_ofs) / 2;
+            if (lt(base[m], key))
+                last_ofs = m + 1;
+            else
+                ofs = m;
+        }
+        return ofs;
+    }
+
+    // Like gallopLeft, but returns k such that base[k-1] <= key < base[k], ie after any equal elements.
+    ssize_t gallopRight(const T& key, T* base, ssize_t len, ssize_t hint) {
+        ssize_t last_ofs = 0, ofs = 1;
+        if (lt(key, base[hint])) {
+            ssize_t max_ofs = hint + 1;
+            while (ofs < max_ofs && lt(key, base[hint - ofs])) {
+                last_ofs = ofs;
+                ofs = (ofs << 1) + 1;
+            }
+            ofs = std::min(ofs, max_ofs);
+            ssize_t t = last_ofs;
+            last_ofs = hint - ofs;
+            ofs = hint - t;
+        } else {
+            ssize_t max_ofs = len - hint;
+            while (ofs < max_ofs && !lt(key, base[hint + ofs])) {
+                last_ofs = ofs;
+                ofs = (ofs << 1) + 1;
+            }
+            ofs = std::min(ofs, max_ofs);
+            last_ofs += hint;
+            ofs += hint;
+        }
+
+        last_ofs++;
+        while (last_ofs < ofs) {
+            ssize_t m = last_ofs + (ofs - last_ofs) / 2;
+            if (lt(key, base[m]))
+                ofs = m;
+            else
+                last_ofs = m + 1;
+        }
+        return ofs;
+    }
+
+    // Merges the adjacent runs a[base1:base1+len1] and a[base2:base2+len2], where len1 <= len2, the first
+    // element of run 2 goes before everything in run 1, and the last element of run 1 goes after everything
+    // in run 2.  Run 1 is moved to the temporary buffer, and the merge proceeds left to right.
+    void mergeLo(ssize_t base1, ssize_t len1, ssize_t base2, ssize_t len2) {
+        ensureTmp(len1);
+        memcpy(tmp, a + base1, len1 * sizeof(T));
+
+        // The hole in the array, a[dest:cursor2], is always exactly big enough for what is left of tmp.
+        ssize_t cursor1 = 0, cursor2 = base2, dest = base1;
+        a[dest++] = a[cursor2++];
+        len2--;
+
+        try {
+            if (len2 == 0 || len1 == 1)
+                goto done;
+
+            while (true) {
+                int count1 = 0, count2 = 0;
+
+                // Straightforward merge, until one run starts winning consistently:
+                do {
+                    if (lt(a[cursor2], tmp[cursor1])) {
+                        a[dest++] = a[cursor2++];
+                        count2++;
+                        count1 = 0;
+                        if (--len2 == 0)
+                            goto done;
+                    } else {
+                        a[dest++] = tmp[cursor1++];
+                        count1++;
+                        count2 = 0;
+                        if (--len1 == 1)
+                            goto done;
+                    }
+                } while ((count1 | count2) < min_gallop);
+
+                // Galloping, until neither run is winning by much any more:
+                do {
+                    count1 = gallopRight(a[cursor2], tmp + cursor1, len1, 0);
+                    if (count1) {
+                        memcpy(a + dest, tmp + cursor1, count1 * sizeof(T));
+                        dest += count1;
+                        cursor1 += count1;
+                        len1 -= count1;
+                        if (len1 <= 1)
+                            goto done;
+                    }
+                    a[dest++] = a[cursor2++];
+                    if (--len2 == 0)
+                        goto done;
+
+                    count2 = gallopLeft(tmp[cursor1], a + cursor2, len2, 0);
+                    if (count2) {
+                        memmove(a + dest, a + cursor2, count2 * sizeof(T));
+                        dest += count2;
+                        cursor2 += count2;
+                        len2 -= count2;
+                        if (len2 == 0)
+                            goto done;
+                    }
+                    a[dest++] = tmp[cursor1++];
+                    if (--len1 == 1)
+                        goto done;
+
+                    min_gallop--;
+                } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+
+                // Penalize leaving galloping mode:
+                min_gallop = std::max(min_gallop, 0) + 2;
+            }
+        } catch (Box* e) {
+            memcpy(a + dest, tmp + cursor1, len1 * sizeof(T));
+            throw;
+        }
+
+    done:
+        min_gallop = std::max(min_gallop, 1);
+        if (len1 == 1 && len2 > 0) {
+            // The last element of run 1 goes after everything that's left of run 2.
+            memmove(a + dest, a + cursor2, len2 * sizeof(T));
+            a[dest + len2] = tmp[cursor1];
+        } else {
+            // len1 can only be 0 here if the comparison function is inconsistent.
+            memcpy(a + dest, tmp + cursor1, len1 * sizeof(T));
+        }
+    }
+
+    // Same as mergeLo, for when len1 >= len2: run 2 goes to the temporary buffer, and the merge
+    // proceeds right to left.
+    void mergeHi(ssize_t base1, ssize_t len1, ssize_t base2, ssize_t len2) {
+        ensureTmp(len2);
+        memcpy(tmp, a + base2, len2 * sizeof(T));
+
+        // The hole in the array, a[cursor1+1:dest+1], is always exactly big enough for tmp[:len2].
+        ssize_t cursor1 = base1 + len1 - 1, cursor2 = len2 - 1, dest = base2 + len2 - 1;
+        a[dest--] = a[cursor1--];
+        len1--;
+
+        try {
+            if (len1 == 0 || len2 == 1)
+                goto done;
+
+            while (true) {
+                int count1 = 0, count2 = 0;
+
+                do {
+                    if (lt(tmp[cursor2], a[cursor1])) {
+                        a[dest--] = a[cursor1--];
+                        count1++;
+                        count2 = 0;
+                        if (--len1 == 0)
+                            goto done;
+                    } else {
+                        a[dest--] = tmp[cursor2--];
+                        count2++;
+                        count1 = 0;
+                        if (--len2 == 1)
+                            goto done;
+                    }
+                } while ((count1 | count2) < min_gallop);
+
+                do {
+                    count1 = len1 - gallopRight(tmp[cursor2], a + base1, len1, len1 - 1);
+                    if (count1) {
+                        dest -= count1;
+                        cursor1 -= count1;
+                        len1 -= count1;
+                        memmove(a + dest + 1, a + cursor1 + 1, count1 * sizeof(T));
+                        if (len1 == 0)
+                            goto done;
+                    }
+                    a[dest--] = tmp[cursor2--];
+                    if (--len2 == 1)
+                        goto done;
+
+                    count2 = len2 - gallopLeft(a[cursor1], tmp, len2, len2 - 1);
+                    if (count2) {
+                        dest -= count2;
+                        cursor2 -= count2;
+                        len2 -= count2;
+                        memcpy(a + dest + 1, tmp + cursor2 + 1, count2 * sizeof(T));
+                        if (len2 <= 1)
+                            goto done;
+                    }
+                    a[dest--] = a[cursor1--];
+                    if (--len1 == 0)
+                        goto done;
+
+                    min_gallop--;
+                } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+
+                min_gallop = std::max(min_gallop, 0) + 2;
+            }
+        } catch (Box* e) {
+            memcpy(a + dest - (len2 - 1), tmp, len2 * sizeof(T));
+            throw;
+        }
+
+    done:
+        min_gallop = std::max(min_gallop, 1);
+        if (len2 == 1 && len1 > 0) {
+            // The first element of run 2 goes before everything that's left of run 1.
+            dest -= len1;
+            cursor1 -= len1;
+            memmove(a + dest + 1, a + cursor1 + 1, len1 * sizeof(T));
+            a[dest] = tmp[cursor2];
+        } else {
+            memcpy(a + dest - (len2 - 1), tmp, len2 * sizeof(T));
+        }
+    }
+
+    // Merges runs i and i+1, which have to be the second- and third-to-last, or the last two.
+    void mergeAt(int i) {
+        assert(num_runs >= 2 && (i == num_runs - 2 || i == num_runs - 3));
+
+        ssize_t base1 = runs[i].base, len1 = runs[i].len;
+        ssize_t base2 = runs[i + 1].base, len2 = runs[i + 1].len;
+        assert(base1 + len1 == base2);
+
+        runs[i].len = len1 + len2;
+        if (i == num_runs - 3)
+            runs[i + 1] = runs[i + 2];
+        num_runs--;
+
+        // Elements at the start of run 1 that are already in place can be left alone:
+        ssize_t k = gallopRight(a[base2], a + base1, len1, 0);
+        base1 += k;
+        len1 -= k;
+        if (len1 == 0)
+            return;
+
+        // And so can elements at the end of run 2:
+        len2 = gallopLeft(a[base1 + len1 - 1], a + base2, len2, len2 - 1);
+        if (len2 == 0)
+            return;
+
+        if (len1 <= len2)
+            mergeLo(base1, len1, base2, len2);
+        else
+            mergeHi(base1, len1, base2, len2);
+    }
+
+    // Merges pending runs until their lengths satisfy, from the top of the stack down,
+    //   runs[i-2].len > runs[i-1].len + runs[i].len  and  runs[i-1].len > runs[i].len
+    // which keeps the stack shallow and the merges balanced.
+    void mergeCollapse() {
+        while (num_runs > 1) {
+            int n = num_runs - 2;
+            if ((n > 0 && runs[n - 1].len <= runs[n].len + runs[n + 1].len)
+                || (n > 1 && runs[n - 2].len <= runs[n - 1].len + runs[n].len)) {
+                if (runs[n - 1].len < runs[n + 1].len)
+                    n--;
+            } else if (runs[n].len > runs[n + 1].len) {
+                break;
+            }
+            mergeAt(n);
+        }
+    }
+
+    void mergeForceCollapse() {
+        while (num_runs > 1) {
+            int n = num_runs - 2;
+            if (n > 0 && runs[n - 1].len < runs[n + 1].len)
+                n--;
+            mergeAt(n);
+        }
+    }
+
+    void run(ssize_t n) {
+        if (n < 2)
+            return;
+
+        if (n < MIN_MERGE) {
+            binaryInsertionSort(0, n, countRun(0, n));
+            return;
+        }
+
+        ssize_t min_run = minRunLength(n);
+        ssize_t lo = 0;
+        while (lo < n) {
+            ssize_t run = countRun(lo, n);
+            if (run < min_run) {
+                ssize_t forced = std::min(n - lo, min_run);
+                binaryInsertionSort(lo, lo + forced, lo + run);
+                run = forced;
+            }
+
+            assert(num_runs < MAX_RUNS);
+            runs[num_runs++] = Run{ lo, run };
+            mergeCollapse();
+
+            lo += run;
+        }
+
+        mergeForceCollapse();
+        assert(num_runs == 1 && runs[0].len == n);
+    }
+
+public:
+    static void sort(T* a, ssize_t n, Lt lt = Lt()) { TimSort(a, lt).run(n); }
+};
+
+template <typename T, typename Lt> void timsort(T* a, ssize_t n, Lt lt = Lt()) {
+    TimSort<T, Lt>::sort(a, n, lt);
+}
+}
+
+#endif
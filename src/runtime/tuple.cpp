@@ -95,7 +95,7 @@ Box* tupleGetitem(BoxedTuple* self, Box* slice) {
     else if (slice->cls == slice_cls)
         return tupleGetitemSlice(self, static_cast<BoxedSlice*>(slice));
     else
-        raiseExcHelper(TypeError, "tuple indices must be integers, not %s", getTypeName(slice)->c_str());
+        raiseExcHelper(TypeError, "tuple indices must be integers, not %s", getTypeName(slice));
 }
 
 Box* tupleAdd(BoxedTuple* self, Box* rhs) {
@@ -127,7 +127,7 @@ Box* tupleRepr(BoxedTuple* t) {
             os << ", ";
 
         BoxedString* elt_repr = static_cast<BoxedString*>(repr(t->elts[i]));
-        os << elt_repr->s;
+        os << elt_repr->s.str();
     }
     if (n == 1)
         os << ",";
@@ -246,12 +246,12 @@ Box* tupleHash(BoxedTuple* self) {
 
 extern "C" Box* tupleNew(Box* _cls, BoxedTuple* args, BoxedDict* kwargs) {
     if (!isSubclass(_cls->cls, type_cls))
-        raiseExcHelper(TypeError, "tuple.__new__(X): X is not a type object (%s)", getTypeName(_cls)->c_str());
+        raiseExcHelper(TypeError, "tuple.__new__(X): X is not a type object (%s)", getTypeName(_cls));
 
     BoxedClass* cls = static_cast<BoxedClass*>(_cls);
     if (!isSubclass(cls, tuple_cls))
-        raiseExcHelper(TypeError, "tuple.__new__(%s): %s is not a subtype of tuple", getNameOfClass(cls)->c_str(),
-                       getNameOfClass(cls)->c_str());
+        raiseExcHelper(TypeError, "tuple.__new__(%s): %s is not a subtype of tuple", getNameOfClass(cls),
+                       getNameOfClass(cls));
 
     RELEASE_ASSERT(cls == tuple_cls, "");
 
@@ -276,7 +276,7 @@ extern "C" Box* tupleNew(Box* _cls, BoxedTuple* args, BoxedDict* kwargs) {
             if (kw->s == "sequence")
                 elements = seq.second;
             else
-                raiseExcHelper(TypeError, "'%s' is an invalid keyword argument for this function", kw->s.c_str());
+                raiseExcHelper(TypeError, "'%s' is an invalid keyword argument for this function", kw->c_str());
         }
 
         for (auto e : elements->pyElements())
@@ -77,7 +77,7 @@ llvm::iterator_range<BoxIterator> Box::pyElements() {
         return llvm::iterator_range<BoxIterator>(++BoxIterator(iter), BoxIterator(nullptr));
     }
 
-    raiseExcHelper(TypeError, "'%s' object is not iterable", getTypeName(this)->c_str());
+    raiseExcHelper(TypeError, "'%s' object is not iterable", getTypeName(this));
 }
 
 extern "C" BoxedFunction::BoxedFunction(CLFunction* f)
@@ -146,13 +146,31 @@ BoxedModule::BoxedModule(const std::string& name, const std::string& fn) : Box(m
     this->giveAttr("__file__", boxString(fn));
 }
 
+ICInvalidator& BoxedModule::getGlobalInvalidator(const std::string& name) {
+    ICInvalidator*& invalidator = global_invalidators[internAttrName(name)];
+    if (!invalidator)
+        invalidator = new ICInvalidator();
+    return *invalidator;
+}
+
+void BoxedModule::invalidateGlobal(const std::string& name, bool rebound) {
+    const std::string* interned = internAttrName(name);
+
+    auto it = global_invalidators.find(interned);
+    if (it != global_invalidators.end())
+        it->second->invalidateAll();
+
+    if (rebound)
+        rebound_globals.insert(interned);
+}
+
 std::string BoxedModule::name() {
     Box* name = this->getattr("__name__");
     if (!name || name->cls != str_cls) {
         return "?";
     } else {
         BoxedString* sname = static_cast<BoxedString*>(name);
-        return sname->s;
+        return sname->s.str();
     }
 }
 
@@ -176,12 +194,17 @@ extern "C" void boxGCHandler(GCVisitor* v, Box* b) {
             HCAttrs* attrs = b->getAttrsPtr();
 
             v->visit(attrs->hcls);
-            int nattrs = attrs->hcls->attr_offsets.size();
-            if (nattrs) {
+            int nattrs = attrs->hcls->numAttrs();
+            int ninline = std::min(nattrs, attrs->hcls->num_inline);
+            if (ninline) {
+                Box** inline_attrs = attrs->getInlineAttrs();
+                v->visitRange((void**)&inline_attrs[0], (void**)&inline_attrs[ninline]);
+            }
+            if (nattrs > ninline) {
                 HCAttrs::AttrList* attr_list = attrs->attr_list;
                 assert(attr_list);
                 v->visit(attr_list);
-                v->visitRange((void**)&attr_list->attrs[0], (void**)&attr_list->attrs[nattrs]);
+                v->visitRange((void**)&attr_list->attrs[0], (void**)&attr_list->attrs[nattrs - ninline]);
             }
         }
     } else {
@@ -189,6 +212,14 @@ extern "C" void boxGCHandler(GCVisitor* v, Box* b) {
     }
 }
 
+extern "C" void strGCHandler(GCVisitor* v, Box* b) {
+    boxGCHandler(v, b);
+
+    BoxedString* s = static_cast<BoxedString*>(b);
+    if (s->usesBuffer())
+        v->visit(s->getBuffer());
+}
+
 extern "C" void typeGCHandler(GCVisitor* v, Box* b) {
     boxGCHandler(v, b);
 
@@ -215,6 +246,9 @@ extern "C" void listGCHandler(GCVisitor* v, Box* b) {
     assert(capacity >= size);
     if (capacity)
         v->visit(l->elts);
+    // Unboxed lists don't contain any pointers:
+    if (l->strategy != BoxedList::OBJECT)
+        return;
     if (size)
         v->visitRange((void**)&l->elts->elts[0], (void**)&l->elts->elts[size]);
 
@@ -227,11 +261,7 @@ extern "C" void setGCHandler(GCVisitor* v, Box* b) {
 
     BoxedSet* s = (BoxedSet*)b;
 
-    // This feels like a cludge, but we need to find anything that
-    // the unordered_map might have allocated.
-    // Another way to handle this would be to rt_alloc the unordered_map
-    // as well, though that incurs extra memory dereferences which would
-    // be nice to avoid.
+    // Same as for dicts:
     void** start = (void**)&s->s;
     void** end = start + (sizeof(s->s) / 8);
     v->visitPotentialRange(start, end);
@@ -262,11 +292,8 @@ extern "C" void dictGCHandler(GCVisitor* v, Box* b) {
 
     BoxedDict* d = (BoxedDict*)b;
 
-    // This feels like a cludge, but we need to find anything that
-    // the unordered_map might have allocated.
-    // Another way to handle this would be to rt_alloc the unordered_map
-    // as well, though that incurs extra memory dereferences which would
-    // be nice to avoid.
+    // The table's arrays live in the GC heap, and the entry array is conservatively
+    // scanned, so we just need to visit the pointers to them:
     void** start = (void**)&d->d;
     void** end = start + (sizeof(d->d) / 8);
     v->visitPotentialRange(start, end);
@@ -294,7 +321,7 @@ extern "C" Box* createUserClass(std::string* name, Box* _base, Box* _attr_dict)
     assert(isSubclass(_base->cls, type_cls));
     BoxedClass* base = static_cast<BoxedClass*>(_base);
 
-    ASSERT(_attr_dict->cls == dict_cls, "%s", getTypeName(_attr_dict)->c_str());
+    ASSERT(_attr_dict->cls == dict_cls, "%s", getTypeName(_attr_dict));
     BoxedDict* attr_dict = static_cast<BoxedDict*>(_attr_dict);
 
     BoxedClass* made;
@@ -308,7 +335,7 @@ extern "C" Box* createUserClass(std::string* name, Box* _base, Box* _attr_dict)
 
     for (const auto& p : attr_dict->d) {
         assert(p.first->cls == str_cls);
-        made->giveAttr(static_cast<BoxedString*>(p.first)->s, p.second);
+        made->giveAttr(static_cast<BoxedString*>(p.first)->s.str(), p.second);
     }
 
     if (made->getattr("__doc__") == NULL) {
@@ -330,7 +357,7 @@ extern "C" Box* boxInstanceMethod(Box* obj, Box* func) {
 }
 
 extern "C" BoxedString* noneRepr(Box* v) {
-    return new BoxedString("None");
+    return boxStrConstant("None");
 }
 
 extern "C" Box* noneHash(Box* v) {
@@ -361,7 +388,7 @@ extern "C" BoxedString* functionRepr(BoxedFunction* v) {
         return boxStrConstant("<built-in function chr>");
     if (v == ord_obj)
         return boxStrConstant("<built-in function ord>");
-    return new BoxedString("function");
+    return boxStrConstant("function");
 }
 
 extern "C" {
@@ -414,8 +441,8 @@ Box* sliceRepr(BoxedSlice* self) {
     BoxedString* start = static_cast<BoxedString*>(repr(self->start));
     BoxedString* stop = static_cast<BoxedString*>(repr(self->stop));
     BoxedString* step = static_cast<BoxedString*>(repr(self->step));
-    std::string s = "slice(" + start->s + ", " + stop->s + ", " + step->s + ")";
-    return new BoxedString(s);
+    std::string s = "slice(" + start->s.str() + ", " + stop->s.str() + ", " + step->s.str() + ")";
+    return boxString(s);
 }
 
 Box* typeRepr(BoxedClass* self) {
@@ -427,21 +454,21 @@ Box* typeRepr(BoxedClass* self) {
         RELEASE_ASSERT(m, "");
         if (m->cls == str_cls) {
             BoxedString* sm = static_cast<BoxedString*>(m);
-            os << sm->s << '.';
+            os << sm->s.str() << '.';
         }
 
         Box* n = self->getattr("__name__");
         RELEASE_ASSERT(n, "");
         RELEASE_ASSERT(n->cls == str_cls, "should have prevented you from setting __name__ to non-string");
         BoxedString* sn = static_cast<BoxedString*>(n);
-        os << sn->s;
+        os << sn->s.str();
 
         os << "'>";
 
         return boxString(os.str());
     } else {
         char buf[80];
-        snprintf(buf, 80, "<type '%s'>", getNameOfClass(self)->c_str());
+        snprintf(buf, 80, "<type '%s'>", getNameOfClass(self));
         return boxStrConstant(buf);
     }
 }
@@ -476,10 +503,11 @@ Box* objectNew(BoxedClass* cls, BoxedTuple* args) {
     }
 
     assert(cls->tp_basicsize >= sizeof(Box));
-    void* mem = gc::gc_alloc(cls->tp_basicsize, gc::GCKind::PYTHON);
+    int num_inline = cls->canHaveInlineAttrs() ? cls->num_inline_attrs : 0;
+    void* mem = gc::gc_alloc(cls->tp_basicsize + num_inline * sizeof(Box*), gc::GCKind::PYTHON);
 
     Box* rtn = ::new (mem) Box(cls);
-    initUserAttrs(rtn, cls);
+    initUserAttrs(rtn, cls, num_inline);
     return rtn;
 }
 
@@ -501,8 +529,7 @@ void setupRuntime() {
     None = new Box(none_cls);
     gc::registerStaticRootObj(None);
 
-    // TODO we leak all the string data!
-    str_cls = new BoxedClass(object_cls, NULL, 0, sizeof(BoxedString), false);
+    str_cls = new BoxedClass(object_cls, &strGCHandler, 0, sizeof(BoxedString), false);
 
     // It wasn't safe to add __base__ attributes until object+type+str are set up, so do that now:
     type_cls->giveAttr("__base__", object_cls);
@@ -625,6 +652,7 @@ void setupRuntime() {
     setupTime();
     setupThread();
     setupPosix();
+    setupMmap();
     setupSre();
 
     setupCAPI();
@@ -654,6 +682,10 @@ BoxedModule* createModule(const std::string& name, const std::string& fn) {
 }
 
 void freeHiddenClasses(HiddenClass* hcls) {
+    // Offset maps are shared down a path of hidden classes, and belong to the one at the end of it:
+    if (hcls->offset_map && hcls->offset_map->tip == hcls)
+        delete hcls->offset_map;
+
     for (const auto& p : hcls->children) {
         freeHiddenClasses(p.second);
     }
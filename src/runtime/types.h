@@ -16,10 +16,16 @@
 #define PYSTON_RUNTIME_TYPES_H
 
 #include <ucontext.h>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringRef.h"
 
 #include "core/threading.h"
 #include "core/types.h"
 #include "gc/gc_alloc.h"
+#include "runtime/hashtable.h"
 
 namespace pyston {
 
@@ -63,6 +69,7 @@ void setupMath();
 void setupTime();
 void setupThread();
 void setupPosix();
+void setupMmap();
 void setupSre();
 void setupSysEnd();
 
@@ -87,10 +94,17 @@ extern "C" i64 unboxInt(Box*);
 extern "C" Box* boxFloat(double d);
 extern "C" Box* boxInstanceMethod(Box* obj, Box* func);
 extern "C" Box* boxStringPtr(const std::string* s);
-Box* boxString(const std::string& s);
-Box* boxString(std::string&& s);
+BoxedString* boxString(llvm::StringRef s);
 extern "C" BoxedString* boxStrConstant(const char* chars);
 extern "C" BoxedString* boxStrConstantSize(const char* chars, size_t n);
+// Returns the canonical string object with this value, creating it if necessary.
+BoxedString* internString(llvm::StringRef s);
+// Same, but if there isn't one yet, s becomes the canonical object.
+BoxedString* internString(BoxedString* s);
+// Interns the string if it looks like an identifier, otherwise boxes a new one.
+BoxedString* internIfNameLike(llvm::StringRef s);
+// Returns the position of the first occurrence of needle in haystack at or after start, or npos.
+size_t findSubstring(llvm::StringRef haystack, llvm::StringRef needle, size_t start = 0);
 extern "C" void listAppendInternal(Box* self, Box* v);
 extern "C" void listAppendArrayInternal(Box* self, Box** v, int nelts);
 extern "C" Box* boxCLFunction(CLFunction* f, BoxedClosure* closure, bool isGenerator,
@@ -145,10 +159,62 @@ template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqua
 class conservative_unordered_map
     : public std::unordered_map<K, V, Hash, KeyEqual, StlCompatAllocator<std::pair<const K, V> > > {};
 
+// The most attributes we will store directly inside an object rather than in its HCAttrs' attr_list.
+#define MAX_INLINE_ATTRS 16
+
+// Returns the canonical copy of an attribute name: equal names always map to the same pointer, so
+// hidden classes can compare attribute names by address.  Interned names are never freed.
+const std::string* internAttrName(const std::string& name);
+// Returns the canonical copy of the name if it has already been interned, or NULL if not.  Lookups
+// should use this, so that looking up names that don't exist doesn't make them stick around forever.
+const std::string* findInternedAttrName(const std::string& name);
+
 class HiddenClass : public ConservativeGCObject {
+public:
+    // The first num_inline attributes are stored in the object itself; any others go in the attr_list.
+    // This is fixed for a given tree of hidden classes, so guarding on the hidden class also
+    // determines where each attribute lives.
+    const int num_inline;
+
 private:
-    HiddenClass() {}
-    HiddenClass(const HiddenClass* parent) : attr_offsets(parent->attr_offsets) {}
+    typedef std::pair<const std::string*, HiddenClass*> Child;
+    typedef std::vector<Child, StlCompatAllocator<Child> > ChildList;
+
+    // The offsets of all of the attributes along a single path down the tree, ending at "tip".
+    // Every hidden class on the path can share it: the entries with an offset below its num_attrs
+    // are exactly its attributes.
+    struct OffsetMap {
+        std::unordered_map<const std::string*, int> offsets;
+        HiddenClass* tip;
+    };
+
+    HiddenClass(int num_inline)
+        : num_inline(num_inline), parent(NULL), attr_name(NULL), num_attrs(0), offset_map(NULL) {}
+    HiddenClass(HiddenClass* parent, const std::string* attr_name)
+        : num_inline(parent->num_inline), parent(parent), attr_name(attr_name), num_attrs(parent->num_attrs + 1),
+          offset_map(NULL) {}
+
+    // Hidden classes form a tree of transitions, where each hidden class is its parent plus the
+    // single attribute attr_name at offset num_attrs - 1.  Objects that got their attributes in the
+    // same order share a path through the tree, rather than each hidden class having a copy
+    // of all of its attribute names.
+    HiddenClass* const parent;
+    const std::string* const attr_name;
+    const int num_attrs;
+
+    // Most hidden classes only ever have a couple transitions out of them, so store them in a
+    // small array that's searched by (interned) name.
+    ChildList children;
+
+    // Looking up an attribute means walking up the parent chain.  That's fine for small objects, but
+    // for hidden classes with lots of attributes (ex modules) we use a table, built the first time one
+    // gets looked up.  Tables are extended down the tree rather than copied, so that a chain of n
+    // attributes only costs O(n) space.  They don't contain any GC pointers, so they're allocated
+    // with the system malloc.
+    OffsetMap* offset_map;
+    void ensureOffsetMap();
+
+    friend void freeHiddenClasses(HiddenClass* hcls);
 
 public:
     static HiddenClass* makeRoot() {
@@ -157,20 +223,26 @@ public:
         assert(!made);
         made = true;
 #endif
-        return new HiddenClass();
+        return new HiddenClass(0);
     }
 
-    conservative_unordered_map<std::string, int> attr_offsets;
-    conservative_unordered_map<std::string, HiddenClass*> children;
+    // Returns the root hidden class for objects that were allocated with space for num_inline attributes
+    // directly after their HCAttrs.  (root_hcls is the root for num_inline == 0.)
+    static HiddenClass* getInlineRoot(int num_inline);
+
+    int numAttrs() { return num_attrs; }
+    // Returns the names of the attributes, in offset order.
+    std::vector<const std::string*> getAttrNames();
 
-    HiddenClass* getOrMakeChild(const std::string& attr);
+    HiddenClass* getOrMakeChild(const std::string& attr) { return getOrMakeChild(internAttrName(attr)); }
+    HiddenClass* getOrMakeChild(const std::string* interned_attr);
 
     int getOffset(const std::string& attr) {
-        auto it = attr_offsets.find(attr);
-        if (it == attr_offsets.end())
-            return -1;
-        return it->second;
+        const std::string* interned = findInternedAttrName(attr);
+        return interned ? getOffset(interned) : -1;
     }
+    int getOffset(const std::string* interned_attr);
+
     HiddenClass* delAttrToMakeHC(const std::string& attr);
 };
 
@@ -196,14 +268,101 @@ public:
     BoxedBool(bool b) __attribute__((visibility("default"))) : Box(bool_cls), b(b) {}
 };
 
+// Out-of-line character storage for strings built up by repeated concatenation (see strAdd).
+// Every string that points into a StringBuffer starts at the beginning of chars; the string that
+// ends at "used" is allowed to append to the buffer in place, since no other string can see
+// the characters past their own end.
+struct StringBuffer {
+    size_t capacity;
+    size_t used;
+    char chars[0];
+
+    static StringBuffer* create(size_t capacity) {
+        StringBuffer* rtn = (StringBuffer*)gc_alloc(sizeof(StringBuffer) + capacity, gc::GCKind::UNTRACKED);
+        rtn->capacity = capacity;
+        rtn->used = 0;
+        return rtn;
+    }
+
+    static StringBuffer* fromChars(const char* chars) {
+        return reinterpret_cast<StringBuffer*>(const_cast<char*>(chars) - offsetof(StringBuffer, chars));
+    }
+};
+
 class BoxedString : public Box {
 public:
-    // const std::basic_string<char, std::char_traits<char>, StlCompatAllocator<char> > s;
-    const std::string s;
+    // Usually the characters are stored inline, right after the object, followed by a NUL.
+    // Strings created by concatenation can instead point into a StringBuffer, in which case they
+    // might not be NUL-terminated; use c_str() to get something to pass to C functions.
+    // Strings are immutable: the only time s changes is when c_str() switches it to an equal copy.
+    llvm::StringRef s;
+    // Strings are immutable, so we can cache the hash; 0 means it hasn't been computed yet.
+    size_t hash_cache;
+    // Whether this is the string's entry in the intern table, ie the only interned string with this value.
+    bool interned;
+
+    // BoxedStrings are variable-sized, so they need to be allocated with the number of characters:
+    //   new (n) BoxedString(...)
+    void* operator new(size_t size, size_t nchars) __attribute__((visibility("default"))) {
+        return gc_alloc(size + nchars + 1, gc::GCKind::PYTHON);
+    }
+    void* operator new(size_t size) = delete;
+
+    BoxedString(const char* s, size_t n) __attribute__((visibility("default")))
+    : Box(str_cls), s(storage(), n), hash_cache(0), interned(false) {
+        memcpy(storage(), s, n);
+        storage()[n] = '\0';
+    }
+    explicit BoxedString(llvm::StringRef s) __attribute__((visibility("default")))
+    : BoxedString(s.data(), s.size()) {}
+
+    // Leaves the characters uninitialized, for callers that want to write them in place;
+    // use createUninitialized().
+    explicit BoxedString(size_t n) __attribute__((visibility("default")))
+    : Box(str_cls), s(storage(), n), hash_cache(0), interned(false) {
+        storage()[n] = '\0';
+    }
+
+    // Points at the first n characters of a StringBuffer; allocate with new (0).
+    BoxedString(StringBuffer* buffer, size_t n) __attribute__((visibility("default")))
+    : Box(str_cls), s(buffer->chars, n), hash_cache(0), interned(false) {
+        assert(n <= buffer->used);
+    }
+
+    static BoxedString* createUninitialized(size_t n) { return new (n) BoxedString(n); }
+
+    // The inline character storage; only meant to be written to while the string is being created.
+    char* storage() { return reinterpret_cast<char*>(this + 1); }
+
+    bool usesBuffer() { return s.data() != storage(); }
+    StringBuffer* getBuffer() {
+        assert(usesBuffer());
+        return StringBuffer::fromChars(s.data());
+    }
 
-    BoxedString(const char* s, size_t n) __attribute__((visibility("default"))) : Box(str_cls), s(s, n) {}
-    BoxedString(const std::string&& s) __attribute__((visibility("default"))) : Box(str_cls), s(std::move(s)) {}
-    BoxedString(const std::string& s) __attribute__((visibility("default"))) : Box(str_cls), s(s) {}
+    // Returns the characters, NUL-terminated.
+    const char* c_str();
+
+    size_t hash() {
+        if (hash_cache == 0) {
+            size_t h = llvm::hash_value(s);
+            // Reserve 0 to mean "not computed":
+            hash_cache = h ? h : 1;
+        }
+        return hash_cache;
+    }
+
+    static bool equal(BoxedString* lhs, BoxedString* rhs) {
+        if (lhs == rhs)
+            return true;
+        // Two different interned strings can't have the same value, and neither can two strings
+        // whose hashes we already know to be different:
+        if (lhs->interned && rhs->interned)
+            return false;
+        if (lhs->hash_cache && rhs->hash_cache && lhs->hash_cache != rhs->hash_cache)
+            return false;
+        return lhs->s == rhs->s;
+    }
 };
 
 class BoxedInstanceMethod : public Box {
@@ -218,6 +377,10 @@ class GCdArray {
 public:
     Box* elts[0];
 
+    // Lists with unboxed storage (see BoxedList::Strategy) keep raw values in the same slots:
+    int64_t* ints() { return reinterpret_cast<int64_t*>(elts); }
+    double* floats() { return reinterpret_cast<double*>(elts); }
+
     void* operator new(size_t size, int capacity) {
         assert(size == sizeof(GCdArray));
         return gc_alloc(capacity * sizeof(Box*) + size, gc::GCKind::UNTRACKED);
@@ -230,18 +393,36 @@ public:
     }
 };
 
+static_assert(sizeof(int64_t) == sizeof(Box*) && sizeof(double) == sizeof(Box*), "");
+
 class BoxedList : public Box {
 public:
+    // How the elements are stored in elts.  A list whose elements are all ints, or all floats, keeps
+    // the raw values instead of boxing each one, and doesn't need to be scanned by the GC.  Storing
+    // anything else converts it to OBJECT storage.  An empty list adopts the strategy of whatever
+    // gets stored in it next.
+    enum Strategy : char { OBJECT, INT, FLOAT };
+
     int64_t size, capacity;
     GCdArray* elts;
+    Strategy strategy;
 
     DS_DEFINE_MUTEX(lock);
 
-    BoxedList() __attribute__((visibility("default"))) : Box(list_cls), size(0), capacity(0) {}
+    BoxedList() __attribute__((visibility("default"))) : Box(list_cls), size(0), capacity(0), strategy(OBJECT) {}
 
     void ensure(int space);
     void shrink();
     static const int INITIAL_CAPACITY;
+
+    // Returns the element at index i, boxing it if it is stored unboxed.
+    Box* getitem(int64_t i);
+    // Stores v at index i (which has to be less than the capacity), converting the storage first if v doesn't fit it.
+    void setitem(int64_t i, Box* v);
+    // Makes sure that v can be stored in the list without changing its strategy.
+    void prepareToStore(Box* v);
+    // Switches to OBJECT storage, after which elts can be used as an array of Box*'s.
+    void convertToObjects();
 };
 
 class BoxedTuple : public Box {
@@ -260,7 +441,25 @@ class BoxedFile : public Box {
 public:
     FILE* f;
     bool closed;
-    BoxedFile(FILE* f) __attribute__((visibility("default"))) : Box(file_cls), f(f), closed(false) {}
+    // The stdio buffer, if open() was asked for a specific size; freed when the file gets closed.
+    char* io_buf;
+    BoxedFile(FILE* f) __attribute__((visibility("default"))) : Box(file_cls), f(f), closed(false), io_buf(NULL) {}
+};
+
+// A read-only memory mapping of a file, from the mmap module.  Slicing, searching and reading lines
+// work directly on the mapped pages; only the results get copied into strings.
+extern BoxedClass* mmap_cls;
+class BoxedMmap : public Box {
+public:
+    const char* data;
+    size_t size;
+    size_t pos; // the position used by read(), readline(), seek() and tell()
+    bool closed;
+
+    BoxedMmap(const char* data, size_t size) __attribute__((visibility("default")))
+    : Box(mmap_cls), data(data), size(size), pos(0), closed(false) {}
+
+    llvm::StringRef contents() const { return llvm::StringRef(data, size); }
 };
 
 struct PyHasher {
@@ -269,6 +468,13 @@ struct PyHasher {
 
 struct PyEq {
     bool operator()(Box*, Box*) const;
+
+    // Keys whose comparisons can't run arbitrary code; the hash tables have a faster lookup
+    // mode for when all of their keys are like this.
+    static bool isSimpleKey(Box* b) { return b->cls == str_cls; }
+    static bool simpleEq(Box* lhs, Box* rhs) {
+        return BoxedString::equal(static_cast<BoxedString*>(lhs), static_cast<BoxedString*>(rhs));
+    }
 };
 
 struct PyLt {
@@ -277,7 +483,7 @@ struct PyLt {
 
 class BoxedDict : public Box {
 public:
-    typedef std::unordered_map<Box*, Box*, PyHasher, PyEq, StlCompatAllocator<std::pair<Box*, Box*> > > DictMap;
+    typedef PyHashMap<PyHasher, PyEq> DictMap;
 
     DictMap d;
 
@@ -300,12 +506,28 @@ public:
 };
 
 class BoxedModule : public Box {
+private:
+    // Jitted code can embed the current value of a global as a constant (see getGlobal), as long as it
+    // gets invalidated when that global is rebound.  Both of these are keyed by interned name.
+    std::unordered_map<const std::string*, ICInvalidator*> global_invalidators;
+    // Globals that have been rebound or deleted at some point; we assume these will keep changing,
+    // so they get looked up normally rather than embedded.
+    std::unordered_set<const std::string*> rebound_globals;
+
 public:
     HCAttrs attrs;
     std::string fn; // for traceback purposes; not the same as __file__
 
     BoxedModule(const std::string& name, const std::string& fn);
     std::string name();
+
+    bool canEmbedGlobal(const std::string& name) {
+        const std::string* interned = findInternedAttrName(name);
+        return !interned || rebound_globals.count(interned) == 0;
+    }
+    ICInvalidator& getGlobalInvalidator(const std::string& name);
+    // Should be called before a global gets added, rebound, or deleted.
+    void invalidateGlobal(const std::string& name, bool rebound);
 };
 
 class BoxedSlice : public Box {
@@ -364,12 +586,23 @@ extern BoxedClass* Exception, *AssertionError, *AttributeError, *TypeError, *Nam
 
 // cls should be obj->cls.
 // Added as parameter because it should typically be available
-inline void initUserAttrs(Box* obj, BoxedClass* cls) {
+// num_inline is the number of attribute slots that were allocated after the object's HCAttrs,
+// which has to be zero unless the HCAttrs is at the end of the object.
+inline void initUserAttrs(Box* obj, BoxedClass* cls, int num_inline = 0) {
     assert(obj->cls == cls);
     if (cls->attrs_offset) {
         HCAttrs* attrs = obj->getAttrsPtr();
-        attrs = new ((void*)attrs) HCAttrs();
+        attrs = new ((void*)attrs) HCAttrs(HiddenClass::getInlineRoot(num_inline));
+    } else {
+        assert(num_inline == 0);
     }
 }
+
+inline Box** HCAttrs::getSlot(int offset) {
+    assert(offset >= 0 && offset < hcls->numAttrs());
+    if (offset < hcls->num_inline)
+        return &getInlineAttrs()[offset];
+    return &attr_list->attrs[offset - hcls->num_inline];
+}
 }
 #endif
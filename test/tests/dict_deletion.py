@@ -0,0 +1,40 @@
+# Exercise dicts and sets through lots of growth, deletions and reinsertions.
+
+d = {}
+for i in xrange(1000):
+    d[i] = i * 2
+for i in xrange(0, 1000, 3):
+    d.pop(i)
+print len(d), sum(d.keys()), sum(d.values())
+
+for i in xrange(0, 1000, 6):
+    d[i] = -i
+print len(d), sum(d.keys()), sum(d.values())
+
+# Keep the size constant while cycling through many keys, leaving lots of deleted entries behind:
+d = {}
+for i in xrange(10000):
+    d[i] = i
+    if i >= 10:
+        d.pop(i - 10)
+print len(d), sorted(d.items())
+
+print d.get(9999), d.get(0), d.get(0, "default")
+print d.setdefault(9999, 0), d.setdefault(-1, "new"), d[-1]
+print 9995 in d, 5 in d
+
+# Keys that are equal but not identical:
+d = {}
+for i in xrange(100):
+    d[str(i)] = i
+for i in xrange(100):
+    assert d[str(i)] == i
+print len(d)
+print d.pop("50"), "50" in d, len(d)
+
+s = set()
+for i in xrange(1000):
+    s.add(i % 100)
+    s.add(str(i % 50))
+print len(s), 99 in s, 100 in s, "49" in s, "50" in s
+print sorted(set(range(10)) & set(range(5, 15)))
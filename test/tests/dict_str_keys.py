@@ -0,0 +1,39 @@
+# statcheck: noninit_count('slowpath_getitem') <= 25
+# statcheck: noninit_count('slowpath_setitem') <= 25
+# String-keyed dicts have their own lookup path; make sure it stays correct,
+# including once a non-string key that compares equal to a string shows up.
+
+def f(d, keys):
+    t = 0
+    for i in xrange(1000):
+        for k in keys:
+            d[k] = d[k] + 1
+            t += d[k]
+    return t
+
+keys = ["a", "b", "c", "hello", "world"]
+d = {}
+for k in keys:
+    d[k] = 0
+print f(d, keys)
+print sorted(d.items())
+
+# Strings built at runtime are equal to, but not the same object as, the keys:
+print d["hel" + "lo"], d["".join(["w", "o", "r", "l", "d"])]
+try:
+    d["missing"]
+except KeyError, e:
+    print "KeyError", e
+
+class C(object):
+    def __init__(self, s):
+        self.s = s
+    def __hash__(self):
+        return hash(self.s)
+    def __eq__(self, rhs):
+        return self.s == rhs
+
+d[C("other")] = 5
+print d["other"]
+d["other"] = 6
+print len(d), d["other"]
@@ -0,0 +1,59 @@
+# Reading files by lines, in chunks, and all at once.
+
+fn = "/tmp/pyston_test_file_lines.txt"
+f = open(fn, "w")
+for i in xrange(1000):
+    f.write("line " + str(i) + " " + "x" * (i % 70) + "\n")
+f.write("no newline at the end")
+f.close()
+
+f = open(fn)
+data = f.read()
+print len(data), data.count("\n"), repr(data[-30:])
+print repr(f.read()), repr(f.readline())
+f.close()
+
+f = open(fn)
+lines = f.readlines()
+print len(lines), repr(lines[0]), repr(lines[-1]), len("".join(lines)) == len(data)
+f.close()
+
+n = 0
+total = 0
+for l in open(fn):
+    n += 1
+    total += len(l)
+print n, total
+
+f = open(fn, "r", 0)
+print repr(f.readline()), repr(f.read(10)), repr(f.readline()), len(f.read())
+f.close()
+
+f = open(fn, "r", 100)
+chunks = []
+while True:
+    c = f.read(777)
+    if not c:
+        break
+    chunks.append(c)
+print len(chunks), "".join(chunks) == data
+f.close()
+
+f = open(fn, "w")
+f.write("a\0b\nc\n")
+f.close()
+print [l for l in open(fn)], repr(open(fn).read())
+
+# read(n) should see data that was appended after the file was opened:
+r = open(fn)
+print repr(r.read(3))
+w = open(fn, "a", 0)
+w.write("d" * 100)
+print repr(r.read(50)), len(r.read(80)), repr(r.read(10))
+w.close()
+r.close()
+
+try:
+    f.readline()
+except ValueError, e:
+    print e
@@ -0,0 +1,36 @@
+# run_args: -n
+# statcheck: stats.get('getglobal_embedded', 0) >= 1
+# statcheck: noninit_count('slowpath_getglobal') <= 40
+# Globals and builtins that haven't been rebound get embedded into the jitted
+# code as constants; make sure rebinding, shadowing and deleting them is seen.
+
+def f():
+    return 1
+
+def g(l):
+    t = 0
+    for i in xrange(1000):
+        t += f() + len(l)
+    return t
+
+print g([1, 2])
+
+def f():
+    return 10
+print g([1, 2])
+
+# Shadow the builtin with a module global, then remove the shadowing again:
+def len(l):
+    return 100
+print g([1, 2])
+del len
+print g([1, 2])
+
+# Globals that keep getting rebound:
+n = 0
+def h():
+    return n
+for i in xrange(1000):
+    n = i
+    t = h()
+print n, t
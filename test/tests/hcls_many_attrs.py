@@ -0,0 +1,34 @@
+# Objects with lots of attributes, whose hidden classes share attribute tables along a path
+# of the transition tree, and branch off of it.
+
+class C(object):
+    pass
+
+def fill(o, names):
+    for n in names:
+        setattr(o, n, n.upper())
+
+names = ["a%d" % i for i in xrange(40)]
+
+a = C()
+fill(a, names)
+b = C()
+fill(b, names[:25])
+# b's hidden class is an ancestor of a's, so it can't see a's later attributes:
+print hasattr(b, "a24"), hasattr(b, "a25"), hasattr(b, "a39"), b.a24
+
+# Branch off partway down the same path:
+c = C()
+fill(c, names[:20] + ["x%d" % i for i in xrange(20)])
+print hasattr(c, "a19"), hasattr(c, "a20"), c.x19, hasattr(a, "x0")
+
+del a.a3
+print hasattr(a, "a3"), a.a2, a.a4, a.a39
+a.a3 = 3
+print a.a3, a.a39
+
+# Lookups of names that no object has:
+for i in xrange(1000):
+    if hasattr(a, "never_set_%d" % i) or getattr(c, "also_never_%d" % i, None) is not None:
+        print "wrong"
+print sorted(n for n in names if getattr(a, n) != n.upper())
@@ -0,0 +1,19 @@
+# run_args: -n
+# statcheck: noninit_count('slowpath_runtimecall') < 10
+# Calling a bound method object directly (as opposed to through callattr) with
+# more than two arguments should also get rewritten:
+
+class C(object):
+    def foo(self, a, b, c):
+        print self.n, a, b, c
+
+    def bar(self, a, b, c, d, e):
+        print self.n, a, b, c, d, e
+
+c = C()
+c.n = 5
+f = c.foo
+b = c.bar
+for i in xrange(1000):
+    f(1, i, 3)
+    b(i, 2, 3, 4, i)
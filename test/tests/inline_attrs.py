@@ -0,0 +1,38 @@
+# run_args: -n
+# statcheck: noninit_count('slowpath_getattr') <= 50
+# statcheck: noninit_count('slowpath_setattr') <= 50
+# Instances of user classes get some of their attributes stored inline,
+# sized from how many attributes earlier instances ended up with.
+# Make sure attribute access works on both sides of the inline/out-of-line
+# boundary, including for objects created before the class was resized.
+
+class C(object):
+    def __init__(self, n):
+        for i in xrange(n):
+            setattr(self, "a%d" % i, i)
+
+objs = [C(n) for n in (0, 3, 20, 5, 40, 1)]
+for o in objs:
+    print [getattr(o, "a%d" % i) for i in xrange(40) if hasattr(o, "a%d" % i)]
+
+class P(object):
+    def __init__(self, x, y):
+        self.x = x
+        self.y = y
+        self.z = x + y
+
+t = 0
+for i in xrange(1000):
+    p = P(i, 2)
+    p.x = p.y + p.z
+    p.w = 5
+    t += p.x + p.y + p.z + p.w
+print t
+
+# Deleting attributes has to shift later attributes across the boundary:
+o = C(30)
+for i in xrange(0, 30, 3):
+    delattr(o, "a%d" % i)
+print [getattr(o, "a%d" % i, None) for i in xrange(30)]
+o.a0 = "new"
+print o.a0, o.a29
@@ -0,0 +1,31 @@
+# Interned strings are unique per value, and the intern table doesn't keep strings alive.
+
+a = "hello"
+b = "hel" + "lo"
+print a == b, intern(b) is a, intern(b) is intern(a)
+
+c = "".join(["not an ", "identifier!"])
+d = intern(c)
+print d is c, intern("not an identifier!") is c
+
+try:
+    intern(1)
+except TypeError, e:
+    print e
+
+# Create lots of short-lived interned strings, so that some get collected and removed from the table:
+t = 0
+for i in xrange(100000):
+    s = intern("s" + str(i))
+    if i % 1000 == 0:
+        t += len(s)
+print t
+print intern("s" + "5") == "s5", intern("s" + "5") is intern("s5")
+
+l = "a b c a b c".split()
+print l, l[0] == l[3], l[0] is not l[1]
+d = {}
+for w in l:
+    d[w] = d.get(w, 0) + 1
+print sorted(d.items())
+print "abc" == "abc", "abc" != "abd", "abc" == "ab" + "c", "abc" != "ab" + "c"
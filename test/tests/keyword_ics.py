@@ -1,6 +1,3 @@
-# expected: statfail
-# - rewriter bails on keywords for now
-
 # statcheck: stats['slowpath_runtimecall'] <= 20
 # statcheck: stats.get("slowpath_callclfunc", 0) <= 20
 # statcheck: stats['rewriter_nopatch'] <= 20
@@ -10,3 +7,23 @@ def f(a, b):
 for i in xrange(10000):
     f(a=1, b=2)
     f(b=1, a=2)
+
+# Keywords that land past the first three arguments, mixed with defaults:
+def g(a, b, c=3, d=4, e=5):
+    return a + 10 * b + 100 * c + 1000 * d + 10000 * e
+
+t = 0
+for i in xrange(10000):
+    t += g(1, 2, e=6)
+    t += g(1, d=7, b=8)
+print t
+
+# Errors still have to get raised correctly:
+try:
+    f(1, a=2)
+except TypeError:
+    print "TypeError"
+try:
+    f(1, c=2)
+except TypeError:
+    print "TypeError"
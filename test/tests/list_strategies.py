@@ -0,0 +1,66 @@
+# statcheck: stats.get('list_strategy_conversions', 0) <= 9
+# Lists of only ints or only floats are stored unboxed; make sure they behave the same as any other list,
+# and that each of the nine lists below that has to switch over only gets converted once.
+
+l = []
+for i in xrange(1000):
+    l.append(i * 3)
+print len(l), l[0], l[-1], l[500], sum(l), 2997 in l, 2998 in l, l.index(300), l.count(6)
+
+f = [0.0] * 1000
+for i in xrange(1000):
+    f[i] = f[i - 1] + 0.5
+print f[:3], f[-1], sum(f)
+
+t = 0.0
+for x in f:
+    t += x
+print t
+
+# Storing something of a different type switches the list over:
+l2 = [1, 2, 3]
+l2.append(4.5)
+print l2, type(l2[0]), type(l2[3])
+l2[1] = "two"
+print l2
+f2 = [1.5, 2.5]
+f2.insert(1, 7)
+print f2, [type(x) for x in f2]
+f3 = [1.0, 2.0]
+f3 += [3, None]
+print f3
+f4 = [1, 2] + [3.0]
+print f4
+
+# Once a list is empty again it can pick a new storage:
+l3 = [1, 2]
+del l3[:]
+l3.append(1.5)
+l3.append(2.5)
+print l3
+
+# Slicing, in both directions and with steps:
+l4 = range(20)
+print l4[3:8], l4[::3], l4[::-4], l4[15:2:-5]
+l4[2:5] = [1.5, 2.5]
+print l4
+l4[:] = l4
+print len(l4)
+l5 = [0.25 * i for i in range(10)]
+l5[1:3] = [100, 200]
+print l5
+l5[4:6] = []
+print l5
+
+print sorted([3, -1, 2, 10, 0]), sorted([2.5, -1.0, 1e10, 0.0], reverse=True), sorted([5, 2, 9], key=lambda x: -x)
+l6 = [3.5, 1.5, 2.5]
+l6.reverse()
+print l6, l6.pop(), l6.pop(0), l6
+l7 = [1, 2, 3] * 3
+print l7, l7 == [1, 2, 3, 1, 2, 3, 1, 2, 3], [1, 2] < [1, 3], [1.0, 2.0] == [1, 2]
+
+l8 = [2 ** 62, -2 ** 62, 0]
+print l8, max(l8), min(l8)
+print repr([1e-300, -0.0, 0.1])
+print ", ".join([str(x) for x in [1, 2, 3]])
+print dict([[1, 2.5], [3, 4.5]])
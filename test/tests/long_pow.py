@@ -0,0 +1,14 @@
+# Negative exponents turn long and int powers into floats.
+
+print 2L ** 10, 2L ** 100, 2 ** 100
+print 2L ** -1, 10L ** -3, (-2L) ** -3, 2 ** -2, (-3) ** -1
+print 2L ** -1L, 4L ** (-(2L ** 70)) == 0.0
+print type(2L ** -1), type(2 ** -1)
+print (10L ** 30) ** -1
+
+for b in (0, 0L):
+    for e in (-1, -1L):
+        try:
+            print b ** e
+        except ZeroDivisionError, e:
+            print e
@@ -0,0 +1,31 @@
+# run_args: -n
+# statcheck: stats.get('ic_transitions_to_megamorphic', 0) >= 1
+# statcheck: stats['ic_evictions'] <= 1000
+# A getattr site that sees many different hidden classes should eventually stop
+# getting repatched, and should keep returning the right results after that.
+
+class C(object):
+    pass
+
+def make(i):
+    o = C()
+    if i & 1:
+        o.a = 1
+    if i & 2:
+        o.b = 2
+    if i & 4:
+        o.c = 3
+    if i & 8:
+        o.d = 4
+    o.x = i
+    return o
+
+objs = [make(i) for i in xrange(16)]
+
+def f():
+    t = 0
+    for k in xrange(1000):
+        for o in objs:
+            t += o.x
+    return t
+print f()
@@ -0,0 +1,23 @@
+# run_args: -n
+# statcheck: noninit_count('slowpath_binop') <= 20
+# statcheck: noninit_count('slowpath_compare') <= 20
+# Mixed int/long/float arithmetic and comparisons should get rewritten,
+# including after an int computation overflows into a long.
+
+def f(n):
+    t = 0
+    big = 1 << 62
+    for i in xrange(n):
+        x = big + big
+        print x, x + i, i + x, x - i, i - x, x * i, i * x
+        print x < i, i < x, x == i, i != x, 1.0 <= i
+        print i < 2.5, i == 3.0, i > 1.5
+        print x / 7, x / -7, -x / 7, x ** 2
+        t = t + big
+    return t
+print f(1000)
+
+print 5L + 3, 3 + 5L, 5L - 3, 3 - 5L, 5L * -3, -3 * 5L
+print 7L / 2, 7L / -2, -7L / 2, -7L / -2
+print 5L == 5, 5 == 5L, 4 < 5L, 5L < 4, 5L >= 5, 5 <= 5L, 5L != 5
+print 2L ** 100, 3 < 2.5, 3 >= 3.0
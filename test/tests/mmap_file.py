@@ -0,0 +1,52 @@
+# Read-only memory-mapped files.
+
+import mmap
+
+fn = "/tmp/pyston_test_mmap.txt"
+f = open(fn, "w")
+for i in xrange(500):
+    f.write("record " + str(i) + " " + "y" * (i % 50) + "\n")
+f.write("tail")
+f.close()
+
+f = open(fn)
+m = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+print len(m), repr(m[0]), repr(m[-1]), repr(m[:10]), repr(m[-4:]), repr(m[5:30:3])
+
+try:
+    m[len(m)]
+except IndexError, e:
+    print e
+
+print m.find("record 250"), m.find("record 250", 100, 200), m.find("nope"), m.find("tail", -10)
+
+n = 0
+total = 0
+while True:
+    l = m.readline()
+    if not l:
+        break
+    n += 1
+    total += len(l)
+print n, total, m.tell()
+
+m.seek(7)
+print repr(m.read(5)), m.tell()
+m.seek(-4, 2)
+print repr(m.read(100)), repr(m.read(1))
+
+m.close()
+try:
+    len(m)
+except ValueError, e:
+    print e
+f.close()
+
+f = open(fn, "w")
+f.close()
+f = open(fn)
+try:
+    mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+except ValueError, e:
+    print e
+f.close()
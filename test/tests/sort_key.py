@@ -0,0 +1,87 @@
+# list.sort and sorted(), with key= and reverse=
+
+def pseudorandom(n, seed=12345):
+    r = []
+    for i in xrange(n):
+        seed = (seed * 75 + 74) % 65537
+        r.append(seed % 1000)
+    return r
+
+l = pseudorandom(2000)
+print sorted(l) == sorted(l, reverse=True)[::-1], sorted(l)[:10], sorted(l, reverse=True)[:10]
+
+# Already sorted, reversed, and partially sorted input:
+for l in [range(500), range(500, 0, -1), range(200) + range(100) + range(300, 0, -3), [5] * 100]:
+    l2 = list(l)
+    l2.sort()
+    print len(l2), l2[:5], l2[-5:]
+
+print sorted([3.5, -1.0, 2.25, 0.0, 1e10, -1e-10])
+print sorted(["pear", "apple", "Banana", "", "apple pie", "\xff", "a"])
+print sorted([3, 1.5, 2, 0.5])
+print sorted([(2, "b"), (1, "z"), (2, "a"), (1, "a")])
+
+# Stability, in both directions:
+words = "the quick brown fox jumps over the lazy dog and then some more words".split()
+print sorted(words, key=len)
+print sorted(words, key=len, reverse=True)
+words.sort(key=lambda w: w[-1])
+print words
+
+# The key function gets called exactly once per element:
+calls = []
+def key(x):
+    calls.append(x)
+    return -x
+l = range(20)
+l.sort(key=key)
+print l, len(calls)
+
+class C(object):
+    def __init__(self, n):
+        self.n = n
+    def __lt__(self, other):
+        return self.n < other.n
+    def __repr__(self):
+        return "C(%d)" % self.n
+print sorted([C(3), C(1), C(2)]), sorted([C(3), C(1), C(2)], reverse=True)
+
+class Bad(object):
+    def __lt__(self, other):
+        raise ValueError("no ordering")
+l = [1, 2, Bad(), 3]
+try:
+    l.sort()
+except ValueError, e:
+    print e
+print len(l)
+
+try:
+    [].sort(foo=1)
+except TypeError, e:
+    print e
+
+# Changing the list from inside the sort:
+l = [3, 1, 2]
+def key(x):
+    print len(l),
+    l.append(x)
+    return x
+try:
+    l.sort(key=key)
+except ValueError, e:
+    print e
+print l
+
+class Appender(object):
+    def __init__(self, n):
+        self.n = n
+    def __lt__(self, other):
+        l2.append(0)
+        return self.n < other.n
+l2 = [Appender(i) for i in (5, 3, 4)]
+try:
+    l2.sort()
+except ValueError, e:
+    print e
+print [x.n for x in l2]
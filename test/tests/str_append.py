@@ -0,0 +1,40 @@
+# statcheck: stats.get('str_appends_in_place', 0) >= 100
+# Long concatenations can append in place to a shared buffer; make sure that
+# older strings that share the buffer never see what got appended after them.
+
+s = "x" * 70
+snapshots = []
+for i in xrange(200):
+    s += str(i % 10)
+    if i % 50 == 0:
+        snapshots.append(s)
+print len(s), s[-20:]
+for t in snapshots:
+    print len(t), t[-5:]
+
+# Two different strings appended to the same prefix:
+base = "b" * 100
+a = base + "first"
+b = base + "second"
+print a[-10:], b[-10:], len(a), len(b)
+c = a + "!"
+d = a + "?"
+print c[-6:], d[-6:], a[-6:]
+
+# Appending a string to itself:
+s = "ab" * 40
+s += s
+s += s
+print len(s), s[:4], s[-4:], s == "ab" * 160
+
+# Strings built this way get passed to C functions too:
+f = "1" * 30
+f += "." + "5" * 40
+print float(f) > 1e29, long("9" * 40 + "1" * 30) % 1000
+d = {}
+k = "key_" * 20
+k2 = k + "1"
+k3 = k + "2"
+d[k2] = 1
+d[k + "1"] = 2
+print len(d), d[k2], k3 in d
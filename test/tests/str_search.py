@@ -0,0 +1,18 @@
+# The string search/split/case methods process 16 bytes at a time;
+# exercise them around those boundaries.
+
+for n in [0, 1, 15, 16, 17, 31, 32, 33, 40]:
+    s = ("ab c\tD" * 10)[:n]
+    print n, s.split(), s.split(" "), s.count("b"), s.count("c\tD"), "c\tDa" in s
+    print repr(s.upper()), repr(s.lower()), repr(s.strip()), repr(s.lstrip()), repr(s.rstrip())
+
+hay = "x" * 37 + "needle" + "y" * 20 + "needle"
+print "needle" in hay, "needlf" in hay, "y" * 21 in hay, hay.count("needle"), hay.count("x"), hay.count("")
+print "xneedley" in hay, ("x" * 37 + "ne") in hay, hay.count("xx"), "aaaa".count("aa")
+
+line = "  2014-06-01 12:00:00  GET /index.html  200 \n"
+print line.split(), line.strip().split("  "), len(line.split(" "))
+print " \t\n\v\f\r".split(), repr(" \t\n\v\f\r x \t\n\v\f\r".strip())
+print "MiXeD 123 \xe9\xc9 Case!".lower(), "MiXeD 123 \xe9\xc9 Case!".upper()
+
+print ",".join(["a", "b", "c"]), ",".join([]), ",".join(["only"]), "".join(["x", "y"])
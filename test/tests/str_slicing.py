@@ -0,0 +1,26 @@
+# Strings are built in place for slicing, concatenation, repetition and splitting;
+# check the lengths and contents come out right, including with embedded NULs.
+
+s = "hello world"
+for start in [None, -20, -3, 0, 2, 11, 20]:
+    for stop in [None, -20, -3, 0, 5, 11, 20]:
+        for step in [None, -3, -1, 1, 2, 5]:
+            print repr(s[start:stop:step]),
+    print
+
+print repr(s + "!"), repr("" + ""), repr(s * 0), repr("ab" * 3), len(s * 100)
+
+n = "a\0b\0"
+print len(n), repr(n), repr(n + n), repr(n * 2), repr(n[1:3]), repr(n[::-1])
+print n == "a\0b\0", n == "a\0b", hash(n) == hash("a\0" + "b\0")
+
+print " a  b\tc\n".split(), "".split(), "  ".split(), "abc".split()
+print "a,b,,c".split(","), ",".split(","), "a::b".split("::")
+
+d = {}
+for i in xrange(100):
+    d["k" + str(i)] = i
+t = 0
+for i in xrange(100):
+    t += d["k" + str(i)]
+print t